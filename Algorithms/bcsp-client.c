@@ -0,0 +1,150 @@
+/*
+	A client of the server mode of bcsp-mod.c (see server.h). It sends
+	the problems of the input files to the server, one request for each
+	file on the same connection, and prints the response of each request
+	before sending the next one.
+
+	Syntax:
+	bcsp-client <socket> <method> [options] <inputfile> [<inputfile> ...]
+
+	The options are the ones of a request (see server.h), so
+	bcsp-client /tmp/bcsp.sock walk --seed 1 in.txt
+	solves in.txt with WalkSAT and seed 1.
+
+	Kefsenidis Paraskevas, 2023
+*/
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+// Send the whole buffer. Returns -1 if the server closed the connection.
+int send_all(int fd, char *buf, size_t len)
+{
+	while(len > 0)
+	{
+		ssize_t sent = write(fd, buf, len);
+
+		if(sent <= 0)
+			return -1;
+
+		buf += sent;
+		len -= sent;
+	}
+
+	return 0;
+}
+
+// Send the request line and then the contents of the input file
+int send_request(int fd, char *line, char *filename)
+{
+	char buf[1 << 16];
+	size_t len;
+	FILE *infile = fopen(filename, "r");
+
+	if(infile == NULL)
+	{
+		fprintf(stderr, "Cannot open input file %s. Now exiting...\n", filename);
+		return -1;
+	}
+
+	if(send_all(fd, line, strlen(line)) < 0)
+	{
+		fclose(infile);
+		return -1;
+	}
+
+	while((len = fread(buf, 1, sizeof(buf), infile)) > 0)
+		if(send_all(fd, buf, len) < 0)
+		{
+			fclose(infile);
+			return -1;
+		}
+
+	fclose(infile);
+
+	// The next request starts on a new line
+	return send_all(fd, "\n", 1);
+}
+
+int main(int argc, char **argv)
+{
+	struct sockaddr_un addr;
+	char line[1024];
+	char *buf = NULL;
+	size_t len = 0;
+	FILE *response;
+	int files;
+	int fd;
+
+	if(argc < 4)
+	{
+		printf("Use the following syntax:\n\n");
+		printf("%s <socket> <method> [options] <inputfile> [<inputfile> ...]\n", argv[0]);
+		return -1;
+	}
+
+	// The options are the words up to the first input file, the
+	// ones starting with -- and their values
+	snprintf(line, sizeof(line), "%s", argv[2]);
+
+	for(files = 3; files < argc && strncmp(argv[files], "--", 2) == 0; files++)
+	{
+		strncat(line, " ", sizeof(line) - strlen(line) - 1);
+		strncat(line, argv[files], sizeof(line) - strlen(line) - 1);
+
+		if(strcmp(argv[files], "--adaptive") != 0 && strcmp(argv[files], "--no-preprocess") != 0 && files + 1 < argc)
+		{
+			strncat(line, " ", sizeof(line) - strlen(line) - 1);
+			strncat(line, argv[++files], sizeof(line) - strlen(line) - 1);
+		}
+	}
+
+	strncat(line, "\n", sizeof(line) - strlen(line) - 1);
+
+	// The server closes the connection after a problem it cannot read,
+	// and its response must still be printed
+	signal(SIGPIPE, SIG_IGN);
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	strncpy(addr.sun_path, argv[1], sizeof(addr.sun_path) - 1);
+
+	fd = socket(AF_UNIX, SOCK_STREAM, 0);
+
+	if(fd < 0 || connect(fd, (struct sockaddr *) &addr, sizeof(addr)) < 0)
+	{
+		fprintf(stderr, "Cannot connect to %s. Now exiting...\n", argv[1]);
+		return -1;
+	}
+
+	response = fdopen(dup(fd), "r");
+
+	// Each response is read before the next request is sent
+	for(; files < argc; files++)
+	{
+		if(send_request(fd, line, argv[files]) < 0)
+			shutdown(fd, SHUT_WR);
+
+		while(getline(&buf, &len, response) > 0)
+		{
+			fputs(buf, stdout);
+
+			if(strcmp(buf, "end\n") == 0)
+				break;
+		}
+
+		if(feof(response) || ferror(response))
+			break;
+	}
+
+	free(buf);
+	fclose(response);
+	close(fd);
+
+	return 0;
+}
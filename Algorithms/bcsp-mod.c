@@ -9,38 +9,474 @@
 #include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
 #include "walksat.h"
+#include "probsat.h"
+#include "cwls.h"
 #include "dpll.h"
+#include "hybrid.h"
+#include "incremental.h"
+#include "cache.h"
+#include "server.h"
 
 void syntax_error(char **argv) {
 	printf("Use the following syntax:\n\n");
-	printf("%s <method> <inputfile> <outputfile>\n\n", argv[0]);
+	printf("%s [options] <method> <inputfile> <outputfile>\n", argv[0]);
+	printf("%s [options] serve <socket>\n\n", argv[0]);
 	printf("where:\n");
-	printf("<method> is either 'walk' or 'dpll' (without the quotes)\n");
-	printf("<inputfile> is the name of the file with the problem description\n");
+	printf("<method> is either 'walk', 'probsat', 'cwls', 'dpll' or 'hybrid' (without the quotes)\n");
+	printf("<inputfile> is the name of the file with the problem description (- for a stream of problems on stdin)\n");
 	printf("<outputfile> is the name of the output file with the solution\n");
+	printf("<socket> is the path of the Unix socket the server listens on\n\n");
+	printf("options:\n");
+	printf("--no-preprocess solve the problem as it was read, without making it smaller first\n");
+	printf("--seed <number> seed of the random number generator (walk only)\n");
+	printf("--max-flips <number> flips of each WalkSAT try (default 20000)\n");
+	printf("--max-tries <number> WalkSAT tries, each from a new random assignment (default 1)\n");
+	printf("--timeout <seconds> wall clock time limit of the whole solve (shared by WalkSAT and DPLL in hybrid)\n");
+	printf("--screen <number> start each try from the best of this many random assignments\n");
+	printf("--adaptive adapt the WalkSAT noise during the search, instead of the fixed P\n");
+	printf("--break-fn <poly|exp> function of the ProbSAT probabilities (default selected by K)\n");
+	printf("--cb <number> base of the ProbSAT function (default selected by K)\n");
+	printf("--eps <number> eps of the polynomial ProbSAT function (default 0.9)\n");
+	printf("--jobs <number> DPLL components solved at the same time (default the number of CPUs)\n");
+	printf("--workers <number> problems solved at the same time by the server (default the number of CPUs)\n");
+	printf("--proof <file> write a binary DRAT proof to the file, when the problem has no solution\n");
+	printf("               (<file>_x for the problem x of a stream)\n");
+	printf("--all write every model to the output file, one on each line (dpll only)\n");
+	printf("--cubes write every model as cubes, with 0 for the symbols that can take any value (dpll only)\n");
+	printf("--count only count the models and write their number to the output file (dpll only)\n");
+	printf("--cache <dir> keep the answers in the directory, and answer a problem that is already there from it\n");
+	printf("--checkpoint <file> write the state of the search to the file every few minutes and when it stops\n");
+	printf("--checkpoint-every <seconds> seconds between the checkpoints (default 300)\n");
+	printf("--resume continue the search from the checkpoint file (of the same method and problem)\n");
+	printf("(the walk options also apply to probsat, cwls and the WalkSAT part of hybrid)\n");
+}
+
+// Reads the value of the option at argv[*i], moving *i to it.
+// Returns NULL if the value is missing.
+char *option_value(int argc, char **argv, int *i)
+{
+	if(*i + 1 >= argc)
+	{
+		printf("Missing value for the %s option. Now exiting...\n", argv[*i]);
+		return NULL;
+	}
+
+	return argv[++(*i)];
+}
+
+// Close the proof of the problem, if one was written. The file is only
+// kept when the proof is complete, as it is a proof of no solution.
+void finish_proof(problem *pb, char *prooffname)
+{
+	proof *pf = pb->_proof;
+
+	if(pf == NULL)
+		return;
+
+	if(proof_close(pf))
+		printf("Proof written to %s (%ld clauses added, %ld deleted)\n", prooffname, pf->_added, pf->_deleted);
+
+	else
+	{
+		if(pf->_error)
+			printf("Cannot write the proof file %s\n", prooffname);
+
+		remove(prooffname);
+	}
+
+	pb->_proof = NULL;
+}
+
+// Answer the problem from the cache, if it is there. Returns 1 if it was.
+int cached_problem(problem *pb, cache_key *key, char *outfname)
+{
+	if(!cache_lookup(key, pb))
+		return 0;
+
+	if(pb->_answer == ANSWER_SAT)
+	{
+		printf("\n\nSolution found in the cache (%s)!\n", key->_path); display(pb->_model, pb->_input._n); printf("\n");
+		write_model(pb->_model, pb->_input._n, outfname, pb->_number);
+		printf("Solution verified: yes\n");
+	}
+
+	else
+	{
+		printf("\n\nThere is no solution to the problem (found in the cache, %s)...\n", key->_path);
+		write_model(NULL, 0, outfname, pb->_number);
+	}
+
+	free_cnf(&pb->_input);
+	free(pb->_model);
+	pb->_model = NULL;
+
+	return 1;
+}
+
+// The end of a solved problem: close its proof, keep its answer in
+// the cache (if key is not NULL) and free it
+void finish_problem(problem *pb, char *prooffname, cache_key *key)
+{
+	finish_proof(pb, prooffname);
+
+	if(key != NULL)
+	{
+		cache_store(key, pb);
+		cache_key_free(key);
+	}
+
+	free_problem(pb);
+}
+
+// Preprocess and solve the problem pb (read into pb->_input) with the
+// method, writing a proof to prooffname if it is not NULL. The problem is
+// first looked up in the cache directory cachedir, if it is not NULL, but
+// not when a proof is written, as the cache has no proofs. Each problem
+// gets its own copy of the parameters, as the methods fill the ones that
+// were not given from the problem.
+void solve_problem(char *method, problem *pb, walk_solver walk, prob_data prob, dpll_solver dpll, char *outfname,
+				   char *prooffname, char *cachedir)
+{
+	proof pf;
+	cache_key key;
+	cache_key *keyp = NULL;
+
+	pb->_proof = NULL;
+	pb->_answer = ANSWER_UNKNOWN;
+	pb->_model = NULL;
+
+	if(cachedir != NULL)
+	{
+		keyp = &key;
+		cache_key_make(&key, &pb->_input, cachedir);
+
+		if(prooffname == NULL && cached_problem(pb, &key, outfname))
+		{
+			cache_key_free(&key);
+			return;
+		}
+	}
+
+	// The proof format has no cardinality constraints
+	if(prooffname != NULL && pb->_input._c > 0)
+		printf("No proof is written for a problem with cardinality constraints\n");
+
+	else if(prooffname != NULL && proof_open(&pf, prooffname) == 0)
+		pb->_proof = dpll._proof = &pf;
+
+	if(preprocess_problem(pb))
+	{
+		printf("\n\nThere is no solution to the problem (found by the preprocessing)...\n");
+		write_model(NULL, 0, outfname, pb->_number);
+		pb->_answer = ANSWER_UNSAT;
+		finish_problem(pb, prooffname, keyp);
+		return;
+	}
+
+	// A checkpoint belongs to the problem as it is solved, after the preprocessing
+	if(strcmp(method, "cwls") == 0 && walk._checkpoint != NULL)
+	{
+		printf("No checkpoint is written by cwls\n");
+		walk._checkpoint = dpll._checkpoint = NULL;
+	}
+
+	else if(walk._checkpoint != NULL)
+		walk._checkpoint->_hash = hash_cnf(&pb->_cnf);
+
+	if(strcmp(method, "dpll") == 0 || strcmp(method, "hybrid") == 0)
+		dpll_create(&dpll, &pb->_cnf);
+
+	if(strcmp(method, "dpll") != 0)
+		walk_create(&walk, &pb->_cnf);
+
+	if(strcmp(method, "dpll") == 0 && dpll._enumerate != DPLL_ONE_MODEL)
+		dpll_enumeration(&dpll, outfname);
+	else if (strcmp(method, "dpll") == 0)
+		dpll_satisfaction(&dpll, pb, outfname);
+	else if(strcmp(method, "hybrid") == 0)
+		hybrid(&walk, &dpll, pb, outfname);
+	else if(strcmp(method, "walk") == 0)
+		walksat(&walk, pb, outfname);
+	else if(strcmp(method, "probsat") == 0)
+		probsat(&walk, &prob, pb, outfname);
+	else
+		cwls(&walk, pb, outfname);
+
+	if(strcmp(method, "dpll") == 0 || strcmp(method, "hybrid") == 0)
+		dpll_destroy(&dpll);
+
+	if(strcmp(method, "dpll") != 0)
+		walk_destroy(&walk);
+
+	finish_problem(pb, prooffname, keyp);
 }
 
 int main(int argc, char **argv)                                                                     
 {
-    int err;
+	char *args[3];		// The method, the input and the output file
+	int args_num = 0;
+	char *val;
+	char *prooffname = NULL;	// The proof file, if given
+	char *cachedir = NULL;		// The cache directory, if given
+	checkpoint ck;				// The checkpoints, if a file is given
+	char name[1024];
+	int err = 0;
+	problem pb;
+	walk_solver walk;
+	prob_data prob;
+	dpll_solver dpll;
+	server sv;
+
+	pb._preprocessing = 1;
+	walk_defaults(&walk);
+	prob_defaults(&prob);
+	dpll_defaults(&dpll);
+	sv._workers = 0;
+	sv._cache = NULL;
+	memset(&ck, 0, sizeof(checkpoint));
+	ck._every = CHECKPOINT_EVERY;
+	catch_interrupts();
+
+	for(int i = 1; i < argc; i++)
+	{
+		if(strcmp(argv[i], "--seed") == 0)
+		{
+			if((val = option_value(argc, argv, &i)) == NULL)
+				return -1;
 
-    if (argc != 4) {
+			walk._seed = strtoull(val, NULL, 10);
+		}
+
+		else if(strcmp(argv[i], "--max-flips") == 0)
+		{
+			if((val = option_value(argc, argv, &i)) == NULL)
+				return -1;
+
+			walk._max_flips = strtol(val, NULL, 10);
+		}
+
+		else if(strcmp(argv[i], "--max-tries") == 0)
+		{
+			if((val = option_value(argc, argv, &i)) == NULL)
+				return -1;
+
+			walk._max_tries = strtol(val, NULL, 10);
+		}
+
+		else if(strcmp(argv[i], "--timeout") == 0)
+		{
+			if((val = option_value(argc, argv, &i)) == NULL)
+				return -1;
+
+			walk._time_limit = strtod(val, NULL);
+			dpll._time_limit = walk._time_limit;
+		}
+
+		else if(strcmp(argv[i], "--screen") == 0)
+		{
+			if((val = option_value(argc, argv, &i)) == NULL)
+				return -1;
+
+			walk._screen = strtol(val, NULL, 10);
+		}
+
+		else if(strcmp(argv[i], "--jobs") == 0)
+		{
+			if((val = option_value(argc, argv, &i)) == NULL)
+				return -1;
+
+			dpll._jobs = strtol(val, NULL, 10);
+		}
+
+		else if(strcmp(argv[i], "--workers") == 0)
+		{
+			if((val = option_value(argc, argv, &i)) == NULL)
+				return -1;
+
+			sv._workers = strtol(val, NULL, 10);
+		}
+
+		else if(strcmp(argv[i], "--proof") == 0)
+		{
+			if((prooffname = option_value(argc, argv, &i)) == NULL)
+				return -1;
+		}
+
+		else if(strcmp(argv[i], "--cache") == 0)
+		{
+			if((cachedir = option_value(argc, argv, &i)) == NULL)
+				return -1;
+		}
+
+		else if(strcmp(argv[i], "--checkpoint") == 0)
+		{
+			if((ck._file = option_value(argc, argv, &i)) == NULL)
+				return -1;
+		}
+
+		else if(strcmp(argv[i], "--checkpoint-every") == 0)
+		{
+			if((val = option_value(argc, argv, &i)) == NULL)
+				return -1;
+
+			ck._every = strtod(val, NULL);
+		}
+
+		else if(strcmp(argv[i], "--resume") == 0)
+			ck._resume = 1;
+
+		else if(strcmp(argv[i], "--no-preprocess") == 0)
+			pb._preprocessing = 0;
+
+		else if(strcmp(argv[i], "--all") == 0)
+			dpll._enumerate = DPLL_ALL_MODELS;
+
+		else if(strcmp(argv[i], "--cubes") == 0)
+			dpll._enumerate = DPLL_ALL_CUBES;
+
+		else if(strcmp(argv[i], "--count") == 0)
+			dpll._enumerate = DPLL_COUNT;
+
+		else if(strcmp(argv[i], "--adaptive") == 0)
+			walk._adaptive = 1;
+
+		else if(strcmp(argv[i], "--break-fn") == 0)
+		{
+			if((val = option_value(argc, argv, &i)) == NULL)
+				return -1;
+
+			if(strcmp(val, "poly") == 0)
+				prob._fn = PROB_POLY;
+			else if(strcmp(val, "exp") == 0)
+				prob._fn = PROB_EXP;
+			else
+			{
+				printf("Unknown break function %s. Now exiting...\n", val);
+				return -1;
+			}
+		}
+
+		else if(strcmp(argv[i], "--cb") == 0)
+		{
+			if((val = option_value(argc, argv, &i)) == NULL)
+				return -1;
+
+			prob._cb = strtod(val, NULL);
+		}
+
+		else if(strcmp(argv[i], "--eps") == 0)
+		{
+			if((val = option_value(argc, argv, &i)) == NULL)
+				return -1;
+
+			prob._eps = strtod(val, NULL);
+		}
+
+		else if(strncmp(argv[i], "--", 2) == 0)
+		{
+			printf("Unknown option %s. Now exiting...\n", argv[i]);
+			syntax_error(argv);
+			return -1;
+		}
+
+		else if(args_num < 3)
+			args[args_num++] = argv[i];
+
+		else
+		{
+			args_num++;
+			break;
+		}
+	}
+
+	// The preprocessing keeps only some of the models (the eliminated
+	// symbols get one value), so the models are enumerated on the problem
+	// as it was read. A proof would take the backtracking after each model
+	// for a failure, and the cache only keeps one model.
+	if(dpll._enumerate != DPLL_ONE_MODEL)
+	{
+		if(args_num != 3 || strcmp(args[0], "dpll") != 0 || strcmp(args[1], "-") == 0 || prooffname != NULL ||
+		   cachedir != NULL)
+		{
+			printf("--all, --cubes and --count only work with dpll, on an input file and without --proof or --cache. Now exiting...\n");
+			return -1;
+		}
+
+		pb._preprocessing = 0;
+	}
+
+	if(cachedir != NULL && cache_open(cachedir))
+		return -1;
+
+	// A checkpoint is the state of a single search, and a proof would
+	// miss the part of the search before the resume
+	if(ck._file != NULL || ck._resume)
+	{
+		if(ck._file == NULL || args_num != 3 || strcmp(args[1], "-") == 0 || prooffname != NULL ||
+		   dpll._enumerate != DPLL_ONE_MODEL)
+		{
+			printf("--checkpoint and --resume only work on an input file, without --proof, --all, --cubes\n"
+				   "or --count, and --resume needs --checkpoint. Now exiting...\n");
+			return -1;
+		}
+
+		walk._checkpoint = dpll._checkpoint = &ck;
+	}
+
+	// The server reads the problems from its socket
+	if(args_num == 2 && strcmp(args[0], "serve") == 0)
+	{
+		sv._cache = cachedir;
+		sv._path = args[1];
+		sv._pb = &pb;
+		sv._walk = &walk;
+		sv._prob = &prob;
+		sv._dpll = &dpll;
+
+		return serve(&sv);
+	}
+
+    if (args_num != 3) {
 		printf("Wrong number of arguments. Now exiting...\n");
 		syntax_error(argv);
 		return -1;
 	}
 
-	if (strcmp(argv[1], "dpll") == 0)
-		dpll_satisfaction(argv[2], argv[3]);
-	else if(strcmp(argv[1], "walk") == 0)
+	if(strcmp(args[0], "dpll") != 0 && strcmp(args[0], "walk") != 0 && strcmp(args[0], "probsat") != 0 &&
+	   strcmp(args[0], "cwls") != 0 && strcmp(args[0], "hybrid") != 0)
 	{
-		walk_init(argv[2]);
-		walksat(argv[3]);
-	}
-	else
 		syntax_error(argv);
+		return 0;
+	}
+
+	// A stream of problems, one after the other
+	if(strcmp(args[1], "-") == 0)
+	{
+		setvbuf(stdin, NULL, _IOFBF, 1 << 20);
+
+		for(pb._number = 0; !interrupted && (err = read_cnf_stream(stdin, &pb._input)) == 0; pb._number++)
+		{
+			printf("\nProblem %d\n", pb._number + 1);
+
+			// Each problem of the stream has its own proof
+			if(prooffname != NULL)
+				snprintf(name, sizeof(name), "%s_%d", prooffname, pb._number + 1);
+
+			solve_problem(args[0], &pb, walk, prob, dpll, args[2], ((prooffname != NULL) ? (name) : (NULL)), cachedir);
+		}
+
+		return ((err < 0) ? (-1) : (0));
+	}
+
+	if(read_cnf(args[1], &pb._input))
+		return -1;
+
+	pb._number = 0;
+	solve_problem(args[0], &pb, walk, prob, dpll, args[2], prooffname, cachedir);
+	checkpoint_free(&ck);
 
 	return 0;
-}
\ No newline at end of file
+}
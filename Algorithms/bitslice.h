@@ -0,0 +1,203 @@
+/*
+	Header file containing a bit-sliced evaluation of the clauses, used to
+	check many truth value assignments at once.
+
+	SLICE_LANES (256) assignments are packed, one per bit (lane), so that
+	each literal has SLICE_WORDS 64 bit words, where bit b is the truth value
+	of the literal in the assignment of lane b. The words of a literal are
+	found by its code (see literal.h), so the negative literal has its own
+	words (the complement of the positive ones) and no sign test is needed.
+
+	A clause is then evaluated for all the lanes with K ORs, and the lanes
+	where it is false (AND-NOT) are added to a counter of unsatisfied clauses
+	per lane. The counters are bit-sliced too: plane p holds bit p of the
+	counter of every lane, so adding one to the counters of the false lanes
+	is a ripple carry over the planes, that rarely goes past the first ones.
+
+	The clauses are given as a flat array of literal codes, where the
+	literals of clause i start at start[i] (the layout of cnf.h), which is
+	also the layout of both the WalkSAT Problem and the DPLL clauses.
+
+	Two kernels are provided: a scalar one, with 64 bit words, and one with
+	AVX2, that handles all the SLICE_WORDS words of a literal as a single
+	256 bit register. slice_select picks the AVX2 kernel at runtime, only if
+	the CPU supports it. The number of lanes is the same for both, so the
+	same seed leads to the same search on every machine. Compiling with
+	-DSLICE_NO_AVX2 leaves only the scalar kernel.
+
+	Links used:
+	https://en.wikipedia.org/wiki/Bit_slicing
+	https://gcc.gnu.org/onlinedocs/gcc/x86-Built-in-Functions.html
+
+	Kefsenidis Paraskevas, 2023
+*/
+
+#ifndef BITSLICE_H
+#define BITSLICE_H
+
+#include <pthread.h>
+#include <stdint.h>
+#include <string.h>
+#include "rng.h"
+
+#if !defined(SLICE_NO_AVX2) && defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SLICE_AVX2
+#include <immintrin.h>
+#endif
+
+#define SLICE_WORDS	4						// The words of each literal
+#define SLICE_LANES	(SLICE_WORDS * 64)		// The assignments evaluated at once
+
+// The words of the literal with code lit
+#define _slice_of(slices, lit) ((slices) + (lit) * SLICE_WORDS)
+
+// Number of counter planes, for counters up to m
+int slice_planes(int m)
+{
+	int planes = 1;
+
+	while((1L << planes) <= m)
+		planes++;
+
+	return planes;
+}
+
+// Count the unsatisfied clauses of every lane. count holds
+// planes * SLICE_WORDS words, SLICE_WORDS for each plane.
+void slice_count_scalar(int *clauses, int *start, int m, uint64_t *slices, uint64_t *count, int planes)
+{
+	memset(count, 0, planes * SLICE_WORDS * sizeof(uint64_t));
+
+	for(int i = 0; i < m; i++)
+	{
+		int *clause = clauses + start[i];
+		int k = start[i + 1] - start[i];
+
+		for(int w = 0; w < SLICE_WORDS; w++)
+		{
+			uint64_t sat = 0;
+			uint64_t carry;
+
+			for(int j = 0; j < k; j++)
+				sat |= _slice_of(slices, clause[j])[w];
+
+			// Add one to the counters of the lanes where the clause is false
+			carry = ~sat;
+
+			for(int p = 0; carry; p++)
+			{
+				uint64_t c = count[p * SLICE_WORDS + w];
+
+				count[p * SLICE_WORDS + w] = c ^ carry;
+				carry &= c;
+			}
+		}
+	}
+}
+
+#ifdef SLICE_AVX2
+// The same as slice_count_scalar, with all the words of a literal in one register
+__attribute__((target("avx2")))
+void slice_count_avx2(int *clauses, int *start, int m, uint64_t *slices, uint64_t *count, int planes)
+{
+	__m256i ones = _mm256_set1_epi64x(-1);
+
+	memset(count, 0, planes * SLICE_WORDS * sizeof(uint64_t));
+
+	for(int i = 0; i < m; i++)
+	{
+		int *clause = clauses + start[i];
+		int k = start[i + 1] - start[i];
+		__m256i sat = _mm256_setzero_si256();
+		__m256i carry;
+
+		for(int j = 0; j < k; j++)
+			sat = _mm256_or_si256(sat, _mm256_loadu_si256((__m256i *) _slice_of(slices, clause[j])));
+
+		carry = _mm256_andnot_si256(sat, ones);
+
+		for(int p = 0; !_mm256_testz_si256(carry, carry); p++)
+		{
+			__m256i *plane = (__m256i *) (count + p * SLICE_WORDS);
+			__m256i c = _mm256_loadu_si256(plane);
+
+			_mm256_storeu_si256(plane, _mm256_xor_si256(c, carry));
+			carry = _mm256_and_si256(c, carry);
+		}
+	}
+}
+#endif
+
+void (*slice_count)(int *clauses, int *start, int m, uint64_t *slices, uint64_t *count, int planes) = slice_count_scalar;
+char *slice_kernel_name = "scalar";
+
+// Select the kernel for the CPU the program runs on (see slice_select)
+void slice_pick(void)
+{
+#ifdef SLICE_AVX2
+	__builtin_cpu_init();
+
+	if(__builtin_cpu_supports("avx2"))
+	{
+		slice_count = slice_count_avx2;
+		slice_kernel_name = "avx2";
+		return;
+	}
+#endif
+
+	slice_count = slice_count_scalar;
+	slice_kernel_name = "scalar";
+}
+
+pthread_once_t slice_once = PTHREAD_ONCE_INIT;
+
+// Select the kernel, only the first time, as the solves of many
+// threads may select it at the same time
+void slice_select(void)
+{
+	pthread_once(&slice_once, slice_pick);
+}
+
+// The number of unsatisfied clauses of a lane
+int slice_lane_count(uint64_t *count, int planes, int lane)
+{
+	int unsat = 0;
+
+	for(int p = 0; p < planes; p++)
+		unsat |= ((count[p * SLICE_WORDS + lane / 64] >> (lane % 64)) & 1) << p;
+
+	return unsat;
+}
+
+// Fill all the lanes with random assignments of n symbols
+void slice_random(uint64_t *slices, int n, rng *r)
+{
+	for(int i = 0; i < n; i++)
+		for(int w = 0; w < SLICE_WORDS; w++)
+		{
+			uint64_t bits = rng_next(r);
+
+			_slice_of(slices, i * 2)[w] = bits;
+			_slice_of(slices, i * 2 + 1)[w] = ~bits;
+		}
+}
+
+// Copy the assignment of a lane to a truth array, indexed by code
+void slice_get_lane(uint64_t *slices, int n, int lane, unsigned char *lit_val)
+{
+	for(int i = 0; i < n; i++)
+	{
+		lit_val[i * 2] = (_slice_of(slices, i * 2)[lane / 64] >> (lane % 64)) & 1;
+		lit_val[i * 2 + 1] = !lit_val[i * 2];
+	}
+}
+
+// Copy a truth array (indexed by code) to all the lanes
+void slice_broadcast(uint64_t *slices, int n, unsigned char *lit_val)
+{
+	for(int i = 0; i < 2 * n; i++)
+		for(int w = 0; w < SLICE_WORDS; w++)
+			_slice_of(slices, i)[w] = ((lit_val[i]) ? (UINT64_MAX) : (0));
+}
+
+#endif
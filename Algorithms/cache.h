@@ -0,0 +1,287 @@
+/*
+	Header file containing the result cache: a directory with the answer of
+	every problem that was solved, so that a problem that is sent again (by
+	a pipeline that solves the same problems many times) is answered
+	without any search.
+
+	The key of a problem is a hash of its canonical form, so that the same
+	problem gives the same key, whatever the order of its clauses and of
+	their literals. The canonical form is a single array of numbers: N, the
+	clauses, each one as its length and its literals (as codes, sorted and
+	without duplicates), in sorted order (by length, then by literals) and
+	without duplicates or always true clauses, and then the cardinality
+	constraints, each one as its length plus 1, its bound and its sorted
+	literals, sorted the same way. The answer is kept in the file
+	<dir>/<16 hex digits of the key>.
+
+	A file with a different problem can have the same key, so an answer
+	is only used after it is checked against the problem: a model must
+	satisfy it (verify_model, one pass over the clauses), and the file of
+	a problem without a solution keeps the canonical form, which must be
+	the same as the one of the problem. A file that does not pass is a
+	miss, and the answer of the problem replaces it.
+
+	The files are written to a temporary file of the directory and renamed
+	to their name, so a reader (another process, or another request of the
+	server) never sees a half written file.
+
+	File: the 8 bytes "BCSPCACH", then the answer (see problem_answer), N
+	and the number of words that follow, as ints, and then the model (N
+	values, 1 or -1) or the canonical form of a problem without a solution.
+
+	Kefsenidis Paraskevas, 2023
+*/
+
+#ifndef CACHE_H
+#define CACHE_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "cnf.h"
+#include "preprocess.h"
+
+#define CACHE_MAGIC "BCSPCACH"
+
+// The key of a problem in the cache
+typedef struct cache_key
+{
+	int *_words;			// The canonical form of the problem
+	int _num;
+	uint64_t _hash;
+	char _path[1024];		// The file of the answer
+} cache_key;
+
+// The words of the records of the canonical form, for compare_records
+// (one for each thread, as the server builds many keys at the same time)
+_Thread_local int *sort_words;
+
+// Compare two records of sort_words (at the given offsets), each one its
+// number of words and then the words, first by their number and then
+// by the words
+int compare_records(const void *a, const void *b)
+{
+	int *u = sort_words + *(const int *) a, *v = sort_words + *(const int *) b;
+
+	for(int i = 0; i <= u[0]; i++)
+		if(u[i] != v[i])
+			return ((u[i] < v[i]) ? (-1) : (1));
+
+	return 0;
+}
+
+// Add the records of recs (at the offsets of start, num of them) to the
+// canonical form in sorted order, without duplicates, after their number
+void cache_add_records(cache_key *k, int *recs, int *start, int num)
+{
+	int count = k->_num++;
+
+	k->_words[count] = 0;
+	sort_words = recs;
+	qsort(start, num, sizeof(int), compare_records);
+
+	for(int i = 0; i < num; i++)
+	{
+		int *r = recs + start[i];
+
+		if(i > 0 && compare_records(&start[i - 1], &start[i]) == 0)
+			continue;
+
+		memcpy(k->_words + k->_num, r, (r[0] + 1) * sizeof(int));
+		k->_num += r[0] + 1;
+		k->_words[count]++;
+	}
+}
+
+// Build the key of the problem f, for the cache directory dir
+void cache_key_make(cache_key *k, cnf *f, char *dir)
+{
+	int total = f->_start[f->_m] + f->_m + _card_total(f) + 2 * f->_c;
+	int *recs = (int *) malloc((total + 1) * sizeof(int));
+	int *start = (int *) malloc((f->_m + f->_c + 1) * sizeof(int));
+	int pos = 0, num = 0;
+
+	k->_words = (int *) malloc((total + 3) * sizeof(int));
+	k->_words[0] = f->_n;
+	k->_num = 1;
+
+	// The clauses: sorted literals, without duplicates, and the always
+	// true ones (a literal next to its opposite, after the sorting) left out
+	for(int i = 0; i < f->_m; i++)
+	{
+		int len = 0, taut = 0;
+
+		memcpy(recs + pos + 1, f->_lits + f->_start[i], _clause_len(f, i) * sizeof(int));
+		qsort(recs + pos + 1, _clause_len(f, i), sizeof(int), compare_int);
+
+		for(int j = 0; j < _clause_len(f, i); j++)
+		{
+			int lit = recs[pos + 1 + j];
+
+			if(len > 0 && recs[pos + len] == lit)
+				continue;
+
+			taut |= (len > 0 && recs[pos + len] == _lit_neg(lit));
+			recs[pos + 1 + len++] = lit;
+		}
+
+		if(taut)
+			continue;
+
+		recs[pos] = len;
+		start[num++] = pos;
+		pos += len + 1;
+	}
+
+	cache_add_records(k, recs, start, num);
+
+	// The constraints keep their duplicate literals, as each one counts
+	pos = num = 0;
+
+	for(int i = 0; i < f->_c; i++)
+	{
+		recs[pos] = _card_len(f, i) + 1;
+		recs[pos + 1] = f->_card_bound[i];
+		memcpy(recs + pos + 2, f->_card_lits + f->_card_start[i], _card_len(f, i) * sizeof(int));
+		qsort(recs + pos + 2, _card_len(f, i), sizeof(int), compare_int);
+
+		start[num++] = pos;
+		pos += recs[pos] + 1;
+	}
+
+	cache_add_records(k, recs, start, num);
+
+	k->_hash = hash_finish(hash_ints(0x6A09E667F3BCC909ULL, k->_words, k->_num));
+
+	snprintf(k->_path, sizeof(k->_path), "%s/%016llx", dir, (unsigned long long) k->_hash);
+
+	free(recs); free(start);
+}
+
+void cache_key_free(cache_key *k)
+{
+	free(k->_words);
+	k->_words = NULL;
+}
+
+// Look the problem of pb (as it was read) up in the cache. Returns 1 if
+// its answer was found and checked, with pb->_answer (and pb->_model, for
+// a model) set.
+int cache_lookup(cache_key *k, problem *pb)
+{
+	FILE *file = fopen(k->_path, "rb");
+	char magic[8];
+	int head[3];			// The answer, N and the number of words
+	int *words;
+	int ok;
+
+	if(file == NULL)
+		return 0;
+
+	// The number of words must be N for a model, and the length of the
+	// canonical form for a problem without a solution
+	if(fread(magic, 1, 8, file) != 8 || memcmp(magic, CACHE_MAGIC, 8) != 0 || fread(head, sizeof(int), 3, file) != 3 ||
+	   head[1] != pb->_input._n || (head[0] != ANSWER_SAT && head[0] != ANSWER_UNSAT) ||
+	   head[2] != ((head[0] == ANSWER_SAT) ? (pb->_input._n) : (k->_num)))
+	{
+		fclose(file);
+		return 0;
+	}
+
+	words = (int *) malloc((head[2] + 1) * sizeof(int));
+	ok = (fread(words, sizeof(int), head[2], file) == (size_t) head[2]);
+	fclose(file);
+
+	if(ok && head[0] == ANSWER_SAT)
+	{
+		for(int i = 0; i < head[2] && ok; i++)
+			ok = (words[i] == 1 || words[i] == -1);
+
+		ok = ok && verify_model(&pb->_input, words);
+	}
+
+	else if(ok)
+		ok = (memcmp(words, k->_words, k->_num * sizeof(int)) == 0);
+
+	if(!ok)
+	{
+		free(words);
+		return 0;
+	}
+
+	pb->_answer = head[0];
+	free(pb->_model);
+	pb->_model = NULL;
+
+	if(head[0] == ANSWER_SAT)
+		pb->_model = words;
+	else
+		free(words);
+
+	return 1;
+}
+
+// Keep the answer of pb (if it has one) in the cache. Nothing is kept
+// if the file cannot be written.
+void cache_store(cache_key *k, problem *pb)
+{
+	char tmp[1040];
+	int head[3] = {pb->_answer, pb->_input._n, 0};
+	int *words = ((pb->_answer == ANSWER_SAT) ? (pb->_model) : (k->_words));
+	FILE *file;
+	int fd, ok;
+
+	if(pb->_answer == ANSWER_UNKNOWN)
+		return;
+
+	head[2] = ((pb->_answer == ANSWER_SAT) ? (pb->_input._n) : (k->_num));
+	snprintf(tmp, sizeof(tmp), "%s.XXXXXX", k->_path);
+
+	// (mkstemp makes the file readable by its owner only)
+	if((fd = mkstemp(tmp)) < 0 || fchmod(fd, 0644) != 0)
+	{
+		if(fd >= 0)
+		{
+			close(fd);
+			remove(tmp);
+		}
+
+		return;
+	}
+
+	if((file = fdopen(fd, "wb")) == NULL)
+	{
+		close(fd);
+		remove(tmp);
+		return;
+	}
+
+	ok = (fwrite(CACHE_MAGIC, 1, 8, file) == 8 && fwrite(head, sizeof(int), 3, file) == 3 &&
+		  fwrite(words, sizeof(int), head[2], file) == (size_t) head[2]);
+
+	if(fclose(file) != 0 || !ok || rename(tmp, k->_path) != 0)
+		remove(tmp);
+}
+
+// Make the cache directory, if it does not exist. Returns -1 if it
+// cannot be made.
+int cache_open(char *dir)
+{
+	struct stat st;
+
+	if(stat(dir, &st) == 0 && S_ISDIR(st.st_mode))
+		return 0;
+
+	if(mkdir(dir, 0777) != 0)
+	{
+		printf("Cannot make the cache directory %s\n", dir);
+		return -1;
+	}
+
+	return 0;
+}
+
+#endif
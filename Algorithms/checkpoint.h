@@ -0,0 +1,227 @@
+/*
+	Header file containing the checkpoints of long searches: the state of a
+	search is written to a file every few minutes (and when the search is
+	stopped by a signal or by the time limit), so that a search that was
+	stopped (or whose machine went down) continues from the checkpoint
+	instead of starting over. WalkSAT (see walksat.h) and DPLL (see dpll.h)
+	write their own state, through the functions below.
+
+	A checkpoint is written to a buffer, which is then written to a
+	temporary file of the same directory, flushed to the disk and renamed
+	to the file of the checkpoint. The rename replaces the previous
+	checkpoint at once, so the file always holds a whole checkpoint, even
+	when the process is killed while it writes. A checkpoint is small (a
+	few bits for each symbol), so writing one costs next to nothing.
+
+	File: the 8 bytes "BCSPCKPT", the name of the search that wrote it (16
+	bytes, such as "WalkSAT" or "DPLL") and the hash of the problem it
+	solves (see hash_cnf), then the state of the search. A checkpoint is
+	only used by a search with the same name, on the same problem (as it
+	is after the preprocessing, which always makes the same problem).
+
+	In order for this to be used, the user has to set _file (and _every
+	and _resume) and _hash, and give the checkpoint to the solvers.
+
+	Link used:
+	https://man7.org/linux/man-pages/man2/rename.2.html
+
+	Kefsenidis Paraskevas, 2023
+*/
+
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define CHECKPOINT_MAGIC	"BCSPCKPT"
+#define CHECKPOINT_NAME		16		// The bytes of the name of the search
+#define CHECKPOINT_EVERY	300		// The default seconds between the checkpoints
+
+typedef struct checkpoint
+{
+	char *_file;			// The file of the checkpoints
+	double _every;			// Seconds between the checkpoints
+	int _resume;			// If the search continues from the checkpoint in _file
+	uint64_t _hash;			// The hash of the problem
+
+	// The checkpoint being written or read
+	unsigned char *_buf;
+	size_t _len;
+	size_t _cap;
+	size_t _pos;			// Where the next value is read from
+} checkpoint;
+
+// Add bytes to the checkpoint being written
+void checkpoint_put(checkpoint *ck, const void *data, size_t bytes)
+{
+	if(ck->_len + bytes > ck->_cap)
+	{
+		ck->_cap = 2 * (ck->_len + bytes);
+		ck->_buf = (unsigned char *) realloc(ck->_buf, ck->_cap);
+	}
+
+	memcpy(ck->_buf + ck->_len, data, bytes);
+	ck->_len += bytes;
+}
+
+// Add n truth values (one bit each), vals[i * stride]. With a stride
+// of 2, they are the positive literals of an assignment indexed by the
+// codes of the literals (see literal.h).
+void checkpoint_put_bits(checkpoint *ck, unsigned char *vals, int n, int stride)
+{
+	unsigned char byte = 0;
+
+	for(int i = 0; i < n; i++)
+	{
+		byte |= (vals[i * stride] != 0) << (i & 7);
+
+		if((i & 7) == 7 || i == n - 1)
+		{
+			checkpoint_put(ck, &byte, 1);
+			byte = 0;
+		}
+	}
+}
+
+// Start a checkpoint of the search with the name
+void checkpoint_begin(checkpoint *ck, char *name)
+{
+	char padded[CHECKPOINT_NAME] = {0};
+
+	strncpy(padded, name, CHECKPOINT_NAME - 1);
+	ck->_len = 0;
+	checkpoint_put(ck, CHECKPOINT_MAGIC, 8);
+	checkpoint_put(ck, padded, CHECKPOINT_NAME);
+	checkpoint_put(ck, &ck->_hash, sizeof(uint64_t));
+}
+
+// Write the checkpoint to its file, replacing the previous one.
+// Returns -1 if it could not be written.
+int checkpoint_write(checkpoint *ck)
+{
+	char tmp[1024];
+	int fd, ok;
+
+	snprintf(tmp, sizeof(tmp), "%s.XXXXXX", ck->_file);
+
+	if((fd = mkstemp(tmp)) < 0)
+	{
+		printf("Cannot write the checkpoint file %s\n", ck->_file);
+		return -1;
+	}
+
+	// The data must be on the disk before the rename makes it the checkpoint
+	ok = (write(fd, ck->_buf, ck->_len) == (ssize_t) ck->_len && fsync(fd) == 0);
+	ok = (close(fd) == 0 && ok);
+
+	if(!ok || rename(tmp, ck->_file) != 0)
+	{
+		printf("Cannot write the checkpoint file %s\n", ck->_file);
+		remove(tmp);
+		return -1;
+	}
+
+	return 0;
+}
+
+// Read the checkpoint of the search with the name, for the problem of
+// _hash. Returns 1 if it was read, with its state (after the name and
+// the hash) ready for checkpoint_get. Prints why it was not read, unless
+// quiet is set.
+int checkpoint_read(checkpoint *ck, char *name, int quiet)
+{
+	FILE *file = fopen(ck->_file, "rb");
+	char padded[CHECKPOINT_NAME] = {0};
+	long size;
+
+	if(file == NULL)
+	{
+		if(!quiet)
+			printf("There is no checkpoint in %s, the search starts from the beginning\n", ck->_file);
+
+		return 0;
+	}
+
+	fseek(file, 0, SEEK_END);
+	size = ftell(file);
+	rewind(file);
+
+	ck->_cap = ((size > 0) ? (size) : (1));
+	ck->_buf = (unsigned char *) realloc(ck->_buf, ck->_cap);
+	ck->_len = ((size > 0) ? (fread(ck->_buf, 1, size, file)) : (0));
+	ck->_pos = 8 + CHECKPOINT_NAME + sizeof(uint64_t);
+	fclose(file);
+
+	strncpy(padded, name, CHECKPOINT_NAME - 1);
+
+	if(ck->_len != (size_t) size || ck->_len < ck->_pos || memcmp(ck->_buf, CHECKPOINT_MAGIC, 8) != 0 ||
+	   memcmp(ck->_buf + 8, padded, CHECKPOINT_NAME) != 0 ||
+	   memcmp(ck->_buf + 8 + CHECKPOINT_NAME, &ck->_hash, sizeof(uint64_t)) != 0)
+	{
+		if(!quiet)
+			printf("The checkpoint in %s is not one of %s on this problem, the search starts from the beginning\n",
+				   ck->_file, name);
+
+		return 0;
+	}
+
+	return 1;
+}
+
+// Take bytes from the checkpoint being read. Returns -1 if it has
+// fewer bytes left.
+int checkpoint_get(checkpoint *ck, void *data, size_t bytes)
+{
+	if(ck->_pos + bytes > ck->_len)
+		return -1;
+
+	memcpy(data, ck->_buf + ck->_pos, bytes);
+	ck->_pos += bytes;
+
+	return 0;
+}
+
+// Take n truth values (see checkpoint_put_bits). With a stride of 2,
+// the negative literals are set too. Returns -1 if there are not enough.
+int checkpoint_get_bits(checkpoint *ck, unsigned char *vals, int n, int stride)
+{
+	if(ck->_pos + (n + 7) / 8 > ck->_len)
+		return -1;
+
+	for(int i = 0; i < n; i++)
+	{
+		vals[i * stride] = (ck->_buf[ck->_pos + i / 8] >> (i & 7)) & 1;
+
+		if(stride == 2)
+			vals[i * 2 + 1] = !vals[i * 2];
+	}
+
+	ck->_pos += (n + 7) / 8;
+
+	return 0;
+}
+
+// If the checkpoint was read up to its end (so it had the right length)
+int checkpoint_done(checkpoint *ck)
+{
+	return ck->_pos == ck->_len;
+}
+
+// Remove the checkpoint, when the search it was for is over
+void checkpoint_remove(checkpoint *ck)
+{
+	remove(ck->_file);
+}
+
+void checkpoint_free(checkpoint *ck)
+{
+	free(ck->_buf);
+	ck->_buf = NULL;
+	ck->_len = ck->_cap = ck->_pos = 0;
+}
+
+#endif
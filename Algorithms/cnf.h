@@ -0,0 +1,473 @@
+/*
+	Header file containing the reader of the input files and the storage
+	of a CNF problem, shared by the algorithms.
+
+	Input File:
+	1st row: N M K
+	then M rows follow, with K integers each, from -N to N, excluding 0
+	(or a problem in the DIMACS format, see read_cnf_stream, which can also
+	have cardinality constraints)
+
+	The clauses are stored one after the other in a single array, as literal
+	codes (see literal.h), and the literals of clause i start at _start[i].
+	The clauses do not need to have the same length, as the preprocessing
+	(see preprocess.h) removes literals from them and adds new ones, so _k
+	is the length of the longest clause.
+
+	A cardinality constraint says that at most (or at least) k of its
+	literals are true. They are stored like the clauses, in their own
+	arrays, always as at most constraints: at least k of the L literals
+	being true is at most L - k of their opposites being true.
+
+	Link used:
+	https://github.com/liffiton/minicard
+
+	Kefsenidis Paraskevas, 2023
+*/
+
+#ifndef CNF_H
+#define CNF_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "literal.h"
+
+// A CNF problem
+typedef struct cnf
+{
+	int _n;			// Number of symbols
+	int _m;			// Number of clauses
+	int _k;			// Length of the longest clause
+	int *_start;	// The first literal of each clause (M + 1, _start[M] is the total length)
+	int *_lits;		// The literals of all the clauses, as codes
+
+	// The cardinality constraints: at most _card_bound[i] of the literals
+	// of constraint i (from _card_start[i], like the clauses) are true.
+	// The arrays are NULL when there are none.
+	int _c;
+	int *_card_start;
+	int *_card_lits;
+	int *_card_bound;
+} cnf;
+
+// The number of literals of clause i
+#define _clause_len(f, i) ((f)->_start[(i) + 1] - (f)->_start[i])
+
+// The number of literals of cardinality constraint i, and of all of them
+#define _card_len(f, i) ((f)->_card_start[(i) + 1] - (f)->_card_start[i])
+#define _card_total(f) (((f)->_c > 0) ? ((f)->_card_start[(f)->_c]) : (0))
+
+void free_cnf(cnf *f)
+{
+	free(f->_start);
+	free(f->_lits);
+	free(f->_card_start);
+	free(f->_card_lits);
+	free(f->_card_bound);
+}
+
+// Read the rest of a cardinality constraint, after its literals (the
+// last len codes of f->_lits): the operator (<= or >=, already in op), the
+// bound and an optional 0. The constraint is added to the ones of f, which
+// have room for it, except for the literals (*cap of them).
+int read_card(FILE *infile, cnf *f, char *op, int len, int *cap, int number)
+{
+	int *lits = f->_lits + f->_start[f->_m];
+	int bound;
+	int c;
+	int end = _card_total(f);
+
+	if (fscanf(infile,"%d",&bound)<1 || bound<0) {
+		printf("Wrong bound of the #%d sentence. Now exiting...\n",number);
+		return -1;
+	}
+
+	// The 0 after the bound is optional
+	while((c = fgetc(infile)) == ' ' || c == '\t');
+
+	if(c == '0' && (c = fgetc(infile)) != EOF && c != ' ' && c != '\t' && c != '\n' && c != '\r') {
+		printf("Wrong end of the #%d sentence. Now exiting...\n",number);
+		return -1;
+	}
+
+	if(c != EOF)
+		ungetc(c, infile);
+
+	if(end + len > *cap) {
+		*cap = 2 * (end + len);
+		f->_card_lits = (int *) realloc(f->_card_lits, *cap * sizeof(int));
+	}
+
+	// At least bound literals are true when at most len - bound
+	// of their opposites are
+	for(int i = 0; i < len; i++)
+		f->_card_lits[end + i] = ((op[0] == '<') ? (lits[i]) : (_lit_neg(lits[i])));
+
+	f->_card_start[f->_c] = end;
+	f->_card_bound[f->_c++] = ((op[0] == '<') ? (bound) : (len - bound));
+	f->_card_start[f->_c] = end + len;
+
+	return 0;
+}
+
+// The clauses and the cardinality constraints of a DIMACS problem
+// (see read_cnf_stream), of any length
+int read_dimacs_clauses(FILE *infile, cnf *f, int N, int M)
+{
+	int len = 0, cap = M * 3 + 1;
+	int card_cap = 0;
+	int i;
+	int err;
+
+	f->_n = N;
+	f->_m = 0;
+	f->_k = 0;
+	f->_start = (int *) malloc((M + 1) * sizeof(int));
+	f->_lits = (int *) malloc(cap * sizeof(int));
+	f->_card_start = (int *) malloc((M + 1) * sizeof(int));
+	f->_card_bound = (int *) malloc((M + 1) * sizeof(int));
+
+	for (i=0;i<M;i++) {
+		int lit;
+		char op[3] = "";
+
+		f->_start[f->_m] = len;
+
+		while(1) {
+			err=fscanf(infile,"%d", &lit);
+			if (err<1) {
+				// The literals of a cardinality constraint end with its operator
+				if (fscanf(infile," %2[<>=]",op)==1 && (strcmp(op,"<=")==0 || strcmp(op,">=")==0))
+					break;
+
+				printf("Cannot read the #%d sentence. Now exiting...\n",i+1);
+				return -1;
+			}
+			if (lit==0)
+				break;
+			if (lit>N || lit<-N) {
+				printf("Wrong value for the #%d proposition of the #%d sentence. Now exiting...\n",len-f->_start[f->_m]+1,i+1);
+				return -1;
+			}
+
+			if (len==cap) {
+				cap *= 2;
+				f->_lits = (int *) realloc(f->_lits, cap * sizeof(int));
+			}
+
+			f->_lits[len++] = _lit_code(lit);
+		}
+
+		if (len==f->_start[f->_m]) {
+			printf("The #%d sentence is empty. Now exiting...\n",i+1);
+			return -1;
+		}
+
+		// The literals of a constraint are moved to the constraints
+		if (op[0]) {
+			if (read_card(infile, f, op, len-f->_start[f->_m], &card_cap, i+1))
+				return -1;
+
+			len = f->_start[f->_m];
+			continue;
+		}
+
+		if (len-f->_start[f->_m]>f->_k)
+			f->_k = len-f->_start[f->_m];
+
+		f->_m++;
+	}
+
+	f->_start[f->_m] = len;
+
+	if (f->_c==0) {
+		free(f->_card_start); free(f->_card_bound);
+		f->_card_start = f->_card_bound = NULL;
+	}
+
+	return 0;
+}
+
+// The readfile from bcsp.c, but modified, so that the problem is stored
+// in a cnf struct and read from a stream. The problem can also be in the
+// DIMACS format: comment lines starting with c, then the line
+// "p cnf N M" and M clauses of any length, each ending with a 0.
+// Some of the M lines can be cardinality constraints, as in the "p cnf+"
+// format of MiniCard: the literals, then <= or >= and the bound (at most
+// or at least that many of the literals are true), optionally followed
+// by a 0. For example "1 -2 3 <= 1" or "1 2 3 4 >= 2 0".
+// Nothing after the last clause is read, so a stream can hold many problems.
+// Returns 1 (without a message) if the stream ends before the problem.
+int read_cnf_stream(FILE *infile, cnf *f)
+{
+	int N, M, K;
+	int i, j;
+	int c;
+	int err;
+	char format[8];
+
+	f->_start = NULL;
+	f->_lits = NULL;
+	f->_c = 0;
+	f->_card_start = NULL;
+	f->_card_lits = NULL;
+	f->_card_bound = NULL;
+
+	// Skip the comments of a DIMACS problem
+	while((c = fgetc(infile)) != EOF)
+	{
+		if(c == 'c')
+		{
+			while((c = fgetc(infile)) != EOF && c != '\n');
+			continue;
+		}
+
+		if(c != ' ' && c != '\t' && c != '\n' && c != '\r')
+			break;
+	}
+
+	if(c == 'p')
+	{
+		if(fscanf(infile, " %7s %d %d", format, &N, &M) < 3 || (strcmp(format, "cnf") != 0 && strcmp(format, "cnf+") != 0) ||
+		   N<1 || M<1) {
+			printf("Wrong problem line of the DIMACS problem. Now exiting...\n");
+			return -1;
+		}
+
+		if(read_dimacs_clauses(infile, f, N, M))
+		{
+			free_cnf(f);
+			return -1;
+		}
+
+		return 0;
+	}
+
+	if(c == EOF)
+		return 1;
+
+	ungetc(c, infile);
+
+	// Reading the number of propositions
+	err=fscanf(infile, "%d", &N);
+	if (err<1) {
+		printf("Cannot read the number of propositions. Now exiting...\n");
+		return -1;
+	}
+
+	if (N<1) {
+		printf("Small number of propositions. Now exiting...\n");
+		return -1;
+	}
+
+	// Reading the number of sentences
+	err=fscanf(infile, "%d", &M);
+	if (err<1) {
+		printf("Cannot read the number of sentences. Now exiting...\n");
+		return -1;
+	}
+
+	if (M<1) {
+		printf("Low number of sentences. Now exiting...\n");
+		return -1;
+	}
+
+	// Reading the number of propositions per sentence
+	err=fscanf(infile, "%d", &K);
+	if (err<1) {
+		printf("Cannot read the number of propositions per sentence. Now exiting...\n");
+		return -1;
+	}
+
+	if (K<2) {
+		printf("Low number of propositions per sentence. Now exiting...\n");
+		return -1;
+	}
+
+	// Allocating memory for the sentences...
+	f->_n = N;
+	f->_m = M;
+	f->_k = K;
+	f->_start = (int *) malloc((M + 1) * sizeof(int));
+	f->_lits = (int *) malloc(M * K * sizeof(int));
+
+	// ...and read them
+	for (i=0;i<M;i++) {
+		f->_start[i] = i * K;
+
+		for(j=0;j<K;j++) {
+			int lit;
+
+			err=fscanf(infile,"%d", &lit);
+			if (err<1) {
+				printf("Cannot read the #%d proposition of the #%d sentence. Now exiting...\n",j+1,i+1);
+				free_cnf(f);
+				return -1;
+			}
+			if (lit==0 || lit>N || lit<-N) {
+				printf("Wrong value for the #%d proposition of the #%d sentence. Now exiting...\n",j+1,i+1);
+				free_cnf(f);
+				return -1;
+			}
+
+			f->_lits[i * K + j] = _lit_code(lit);
+		}
+	}
+
+	f->_start[M] = M * K;
+
+	return 0;
+}
+
+int read_cnf(char *filename, cnf *f)
+{
+	FILE *infile;
+	int err;
+
+	// Opening the input file
+	infile=fopen(filename,"r");
+	if (infile==NULL) {
+		printf("Cannot open input file. Now exiting...\n");
+		return -1;
+	}
+
+	err = read_cnf_stream(infile, f);
+
+	if (err==1) {
+		printf("The input file is empty. Now exiting...\n");
+		err = -1;
+	}
+
+	fclose(infile);
+
+	return err;
+}
+
+// Write the model (1 for true and -1 for false, for each of the n symbols)
+// to the output file. The model of the problem number (of a stream of
+// problems, 0 for the first or only one) is appended on a new line after
+// the ones of the previous problems. A problem without a model (NULL)
+// gets an empty line.
+void write_model(int *model, int n, char *outfname, int number)
+{
+	FILE *outf;
+
+	outf = fopen(outfname, ((number > 0) ? ("a") : ("w")));
+
+	if(outf == NULL)
+	{
+		fprintf(stderr, "An error occured opening the file!");
+		return;
+	}
+
+	if(number > 0)
+		fputc('\n', outf);
+
+	for(int i = 0; model != NULL && i < n; i++)
+		fprintf(outf, "%d ", model[i]);
+
+	fclose(outf);
+}
+
+// Make dst a copy of src
+void copy_cnf(cnf *dst, cnf *src)
+{
+	*dst = *src;
+	dst->_start = (int *) malloc((src->_m + 1) * sizeof(int));
+	dst->_lits = (int *) malloc(src->_start[src->_m] * sizeof(int));
+
+	memcpy(dst->_start, src->_start, (src->_m + 1) * sizeof(int));
+	memcpy(dst->_lits, src->_lits, src->_start[src->_m] * sizeof(int));
+
+	if(src->_c == 0)
+	{
+		dst->_card_start = dst->_card_lits = dst->_card_bound = NULL;
+		return;
+	}
+
+	dst->_card_start = (int *) malloc((src->_c + 1) * sizeof(int));
+	dst->_card_lits = (int *) malloc(_card_total(src) * sizeof(int));
+	dst->_card_bound = (int *) malloc(src->_c * sizeof(int));
+
+	memcpy(dst->_card_start, src->_card_start, (src->_c + 1) * sizeof(int));
+	memcpy(dst->_card_lits, src->_card_lits, _card_total(src) * sizeof(int));
+	memcpy(dst->_card_bound, src->_card_bound, src->_c * sizeof(int));
+}
+
+// Mix num ints into the hash h, one at a time. The hash is finished by
+// hash_finish (the finalizer of splitmix64), so that every bit of it
+// depends on every int.
+uint64_t hash_ints(uint64_t h, int *ints, long num)
+{
+	for(long i = 0; i < num; i++)
+	{
+		h = (h ^ (uint32_t) ints[i]) * 0x9E3779B97F4A7C15ULL;
+		h ^= h >> 32;
+	}
+
+	return h;
+}
+
+uint64_t hash_finish(uint64_t h)
+{
+	h = (h ^ (h >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	h = (h ^ (h >> 27)) * 0x94D049BB133111EBULL;
+
+	return h ^ (h >> 31);
+}
+
+// A hash of the problem as it is stored (so it depends on the order of the
+// clauses and of their literals, unlike the key of the cache, see cache.h)
+uint64_t hash_cnf(cnf *f)
+{
+	int sizes[3] = {f->_n, f->_m, f->_c};
+	uint64_t h = hash_ints(0x6A09E667F3BCC909ULL, sizes, 3);
+
+	h = hash_ints(h, f->_start, f->_m + 1);
+	h = hash_ints(h, f->_lits, f->_start[f->_m]);
+
+	if(f->_c > 0)
+	{
+		h = hash_ints(h, f->_card_start, f->_c + 1);
+		h = hash_ints(h, f->_card_lits, _card_total(f));
+		h = hash_ints(h, f->_card_bound, f->_c);
+	}
+
+	return hash_finish(h);
+}
+
+// Check a model (1 for true and -1 for false, for each symbol) against all
+// the clauses and the cardinality constraints, in a single pass. Returns 1
+// if it satisfies them.
+int verify_model(cnf *f, int *model)
+{
+	for(int i = 0; i < f->_m; i++)
+	{
+		int j = f->_start[i];
+
+		// Skip the false literals (a positive literal of a false symbol,
+		// or a negative one of a true symbol)
+		while(j < f->_start[i + 1] && (model[_lit_var(f->_lits[j])] == 1) == _lit_sign(f->_lits[j]))
+			j++;
+
+		if(j == f->_start[i + 1])
+			return 0;
+	}
+
+	for(int i = 0; i < f->_c; i++)
+	{
+		int true_lits = 0;
+
+		for(int j = f->_card_start[i]; j < f->_card_start[i + 1]; j++)
+			true_lits += ((model[_lit_var(f->_card_lits[j])] == 1) != _lit_sign(f->_card_lits[j]));
+
+		if(true_lits > f->_card_bound[i])
+			return 0;
+	}
+
+	return 1;
+}
+
+#endif
@@ -0,0 +1,151 @@
+/*
+	Header file containing the counters of the model counting (see dpll.h).
+
+	The number of models of a problem quickly grows past 64 bits, as every
+	free symbol doubles it, so a counter is a number of any size: an array
+	of 32 bit words, the lowest first. The counting only needs to add
+	powers of 2 (the models of a cube), to multiply the counts of the
+	components and to print the result in decimal.
+
+	A model_count set to zeros (by memset) is the number 0.
+
+	Kefsenidis Paraskevas, 2023
+*/
+
+#ifndef COUNT_H
+#define COUNT_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct model_count
+{
+	uint32_t *_words;
+	int _num;			// The number of words, without zero words at the top
+} model_count;
+
+void count_free(model_count *c)
+{
+	free(c->_words);
+	c->_words = NULL;
+	c->_num = 0;
+}
+
+// Make room for num words, the new ones zero
+void count_grow(model_count *c, int num)
+{
+	if(num <= c->_num)
+		return;
+
+	c->_words = (uint32_t *) realloc(c->_words, num * sizeof(uint32_t));
+	memset(c->_words + c->_num, 0, (num - c->_num) * sizeof(uint32_t));
+	c->_num = num;
+}
+
+void count_set(model_count *c, uint32_t value)
+{
+	count_free(c);
+
+	if(value > 0)
+	{
+		count_grow(c, 1);
+		c->_words[0] = value;
+	}
+}
+
+int count_is_zero(model_count *c)
+{
+	return c->_num == 0;
+}
+
+// Add 2 ^ e to the counter
+void count_add_pow2(model_count *c, int e)
+{
+	uint64_t carry = (uint64_t) 1 << (e % 32);
+
+	for(int i = e / 32; carry > 0; i++)
+	{
+		count_grow(c, i + 1);
+		carry += c->_words[i];
+		c->_words[i] = (uint32_t) carry;
+		carry >>= 32;
+	}
+}
+
+// Multiply the counter c by the counter by
+void count_mul(model_count *c, model_count *by)
+{
+	int num = c->_num + by->_num;
+	uint32_t *res;
+
+	if(count_is_zero(c) || count_is_zero(by))
+	{
+		count_free(c);
+		return;
+	}
+
+	res = (uint32_t *) calloc(num, sizeof(uint32_t));
+
+	for(int i = 0; i < c->_num; i++)
+	{
+		uint64_t carry = 0;
+
+		for(int j = 0; j < by->_num; j++)
+		{
+			carry += (uint64_t) c->_words[i] * by->_words[j] + res[i + j];
+			res[i + j] = (uint32_t) carry;
+			carry >>= 32;
+		}
+
+		res[i + by->_num] = (uint32_t) carry;
+	}
+
+	while(num > 0 && res[num - 1] == 0)
+		num--;
+
+	free(c->_words);
+	c->_words = res;
+	c->_num = num;
+}
+
+// Print the counter in decimal, by dividing a copy of it by 10^9, once
+// for every 9 digits
+void count_print(FILE *out, model_count *c)
+{
+	uint32_t *w = (uint32_t *) malloc((c->_num + 1) * sizeof(uint32_t));
+	uint32_t *digits = (uint32_t *) malloc((c->_num * 10 / 9 + 2) * sizeof(uint32_t));		// Groups of 9 digits, the lowest first
+	int num = c->_num, groups = 0;
+
+	memcpy(w, c->_words, c->_num * sizeof(uint32_t));
+
+	while(num > 0)
+	{
+		uint64_t rem = 0;
+
+		for(int i = num - 1; i >= 0; i--)
+		{
+			rem = (rem << 32) | w[i];
+			w[i] = (uint32_t) (rem / 1000000000);
+			rem %= 1000000000;
+		}
+
+		digits[groups++] = (uint32_t) rem;
+
+		while(num > 0 && w[num - 1] == 0)
+			num--;
+	}
+
+	if(groups == 0)
+		fprintf(out, "0");
+	else
+		fprintf(out, "%u", digits[groups - 1]);
+
+	for(int i = groups - 2; i >= 0; i--)
+		fprintf(out, "%09u", digits[i]);
+
+	free(w); free(digits);
+}
+
+#endif
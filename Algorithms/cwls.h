@@ -0,0 +1,344 @@
+/*
+	Header file containing a clause weighting local search (CWLS) method,
+	with configuration checking. It must be included after the walksat.h
+	file, as it uses the same walk_solver, occurrence lists and search loop.
+
+	Every clause has a weight, starting from 1. The score of a literal is
+	the total weight of the clauses that become satisfied if the literal is
+	flipped, minus the total weight of those that become unsatisfied. The
+	scores are updated incrementally after each flip, only for the literals
+	that share a clause with the flipped one.
+
+	Configuration checking forbids flipping a literal back, until one of its
+	neighbours (literals that share a clause with it) has been flipped,
+	which keeps the search from cycling. The literals that are allowed to
+	be flipped and have a positive score are the CCD (configuration changed
+	decreasing) literals. In each step:
+	- If CCD literals exist, the one with the greatest score is flipped.
+	- Otherwise the search is in a local minimum. The weights of all the
+	  unsatisfied clauses are increased by 1 and the literal with the
+	  greatest score of the randomly selected unsatisfied clause is flipped.
+	  When the average weight exceeds SWT_THRESHOLD, all the weights are
+	  scaled down (w = SWT_RHO * w, but at least 1), so that old weights
+	  are slowly forgotten. This is the SWT scheme of Swcc, which scales
+	  the weights like SAPS, but only rarely.
+	Ties are broken in favour of the literal that was flipped least recently.
+
+	The user needs to first create a walk_solver, like for WalkSAT, and
+	then call the cwls function, with a file name (the output file).
+	Only clauses have weights, so a problem with cardinality constraints
+	(see cnf.h) is solved by WalkSAT instead.
+
+	Links used:
+	https://lcs.ios.ac.cn/~caisw/Paper/Swcc-AIJ.pdf
+	https://www.cs.ubc.ca/~hoos/Publ/ccsh-02.pdf (SAPS)
+
+	Kefsenidis Paraskevas, 2023.
+*/
+
+#define SWT_THRESHOLD	300		// Average weight that triggers smoothing
+#define SWT_RHO			0.3
+
+// The state of CWLS, kept in the _data of the walk_solver
+typedef struct cw_data
+{
+	int *_clause_weight;	// The weight of each clause (M)
+	int *_score;			// The score of each literal (N)
+	char *_conf_changed;	// If a neighbour of the literal was flipped, since its last flip (N)
+	long *_flip_time;		// The step of the last flip of each literal (N)
+	long _steps;
+
+	// The CCD literals, stored like the unsatisfied clauses
+	int *_ccd_lits;
+	int *_ccd_pos;			// -1 for literals that are not CCD
+	int _ccd_num;
+
+	long _total_weight;		// The sum of all the weights
+	long _local_minima;		// Statistics: number of weight increases
+	long _smoothings;		// Statistics: number of smoothings
+} cw_data;
+
+// Add or remove a literal from the CCD literals, if needed
+void update_ccd(cw_data *c, int lit_num)
+{
+	int is_ccd = c->_score[lit_num] > 0 && c->_conf_changed[lit_num];
+
+	if(is_ccd && c->_ccd_pos[lit_num] < 0)
+	{
+		c->_ccd_pos[lit_num] = c->_ccd_num;
+		c->_ccd_lits[c->_ccd_num++] = lit_num;
+	}
+
+	else if(!is_ccd && c->_ccd_pos[lit_num] >= 0)
+	{
+		int last = c->_ccd_lits[--c->_ccd_num];
+
+		c->_ccd_lits[c->_ccd_pos[lit_num]] = last;
+		c->_ccd_pos[last] = c->_ccd_pos[lit_num];
+		c->_ccd_pos[lit_num] = -1;
+	}
+}
+
+// Returns the literal number of the first true literal of a clause,
+// other than skip (-1 to not skip any), or -1 if there is none
+int true_lit_of(walk_solver *w, int clause_num, int skip, unsigned char *lit_assign)
+{
+	int *clause = _clause_of(w, clause_num);
+
+	for(int i = 0; i < _len_of(w, clause_num); i++)
+		if(_lit_var(clause[i]) != skip && lit_assign[clause[i]])
+			return _lit_var(clause[i]);
+
+	return -1;
+}
+
+// Add weight to the score of all the literals of a clause
+void add_to_clause_scores(walk_solver *w, int clause_num, int weight)
+{
+	cw_data *c = (cw_data *) w->_data;
+	int *clause = _clause_of(w, clause_num);
+
+	for(int i = 0; i < _len_of(w, clause_num); i++)
+		c->_score[_lit_var(clause[i])] += weight;
+}
+
+// Update the CCD literals, for all the literals of a clause
+void update_clause_ccd(walk_solver *w, int clause_num)
+{
+	int *clause = _clause_of(w, clause_num);
+
+	for(int i = 0; i < _len_of(w, clause_num); i++)
+		update_ccd((cw_data *) w->_data, _lit_var(clause[i]));
+}
+
+// Calculate all the scores and the CCD literals from scratch
+void init_scores(walk_solver *w, unsigned char *lit_assign)
+{
+	cw_data *c = (cw_data *) w->_data;
+	int crit;
+
+	c->_ccd_num = 0;
+
+	for(int i = 0; i < w->_n; i++)
+	{
+		c->_score[i] = 0;
+		c->_ccd_pos[i] = -1;
+	}
+
+	// An unsatisfied clause contributes its weight to the scores of all its
+	// literals, while a clause with one true literal contributes it (negative)
+	// to the score of that literal only.
+	for(int i = 0; i < w->_m; i++)
+	{
+		if(w->_true_num[i] == 0)
+			add_to_clause_scores(w, i, c->_clause_weight[i]);
+
+		else if(w->_true_num[i] == 1 && (crit = true_lit_of(w, i, -1, lit_assign)) >= 0)
+			c->_score[crit] -= c->_clause_weight[i];
+	}
+
+	for(int i = 0; i < w->_n; i++)
+		update_ccd(c, i);
+}
+
+// Increase the weights of the unsatisfied clauses and
+// smooth all of them when the average gets too big
+void update_weights(walk_solver *w, unsigned char *lit_assign)
+{
+	cw_data *c = (cw_data *) w->_data;
+
+	c->_local_minima++;
+
+	for(int i = 0; i < w->_false_num; i++)
+	{
+		c->_clause_weight[w->_false_clauses[i]]++;
+		add_to_clause_scores(w, w->_false_clauses[i], 1);
+		update_clause_ccd(w, w->_false_clauses[i]);
+	}
+
+	c->_total_weight += w->_false_num;
+
+	if(c->_total_weight / w->_m <= SWT_THRESHOLD)
+		return;
+
+	// Smoothing changes the weights of all the clauses, so
+	// the scores are calculated again
+	c->_smoothings++;
+	c->_total_weight = 0;
+
+	for(int i = 0; i < w->_m; i++)
+	{
+		c->_clause_weight[i] = SWT_RHO * c->_clause_weight[i];
+
+		if(c->_clause_weight[i] < 1)
+			c->_clause_weight[i] = 1;
+
+		c->_total_weight += c->_clause_weight[i];
+	}
+
+	init_scores(w, lit_assign);
+}
+
+// Returns 1 if literal a is a better choice than literal b
+int better_lit(cw_data *c, int a, int b)
+{
+	return c->_score[a] > c->_score[b] || (c->_score[a] == c->_score[b] && c->_flip_time[a] < c->_flip_time[b]);
+}
+
+// Pick the literal to flip, as described at the top of the file
+int cw_pick_lit(walk_solver *w, int *clause, int len, unsigned char *lit_assign)
+{
+	cw_data *c = (cw_data *) w->_data;
+	int best;
+
+	if(c->_ccd_num > 0)
+	{
+		best = c->_ccd_lits[0];
+
+		for(int i = 1; i < c->_ccd_num; i++)
+			if(better_lit(c, c->_ccd_lits[i], best))
+				best = c->_ccd_lits[i];
+
+		return best;
+	}
+
+	update_weights(w, lit_assign);
+
+	best = _lit_var(clause[0]);
+
+	for(int i = 1; i < len; i++)
+		if(better_lit(c, _lit_var(clause[i]), best))
+			best = _lit_var(clause[i]);
+
+	return best;
+}
+
+// Initialize the weights, scores and configurations at the
+// beginning of a try
+void cw_start(walk_solver *w, unsigned char *lit_assign)
+{
+	cw_data *c = (cw_data *) w->_data;
+
+	c->_steps = 1;
+	c->_total_weight = w->_m;
+
+	for(int i = 0; i < w->_n; i++)
+	{
+		c->_conf_changed[i] = 1;
+		c->_flip_time[i] = 0;
+	}
+
+	for(int i = 0; i < w->_m; i++)
+		c->_clause_weight[i] = 1;
+
+	init_scores(w, lit_assign);
+}
+
+// Update the scores and the configurations after lit_num was flipped.
+// true_num is already updated by flip, so the number of true literals
+// of each clause before the flip is known.
+void cw_flipped(walk_solver *w, int lit_num, unsigned char *lit_assign)
+{
+	cw_data *c = (cw_data *) w->_data;
+	int made, broken;		// The occurrence lists of the literals that became true and false
+	int other;
+
+	made = _true_lit(lit_num, lit_assign[lit_num * 2]);
+	broken = _lit_neg(made);
+
+	for(int i = w->_occ_start[made]; i < w->_occ_start[made + 1]; i++)
+	{
+		int cl = w->_occ[i];
+		int weight = c->_clause_weight[cl];
+
+		// The clause became satisfied, by lit_num only
+		if(w->_true_num[cl] == 1)
+		{
+			add_to_clause_scores(w, cl, -weight);
+			c->_score[lit_num] -= weight;
+		}
+
+		// The clause no longer depends on its other true literal
+		else if(w->_true_num[cl] == 2 && (other = true_lit_of(w, cl, lit_num, lit_assign)) >= 0)
+			c->_score[other] += weight;
+	}
+
+	for(int i = w->_occ_start[broken]; i < w->_occ_start[broken + 1]; i++)
+	{
+		int cl = w->_occ[i];
+		int weight = c->_clause_weight[cl];
+
+		// The clause became unsatisfied
+		if(w->_true_num[cl] == 0)
+		{
+			add_to_clause_scores(w, cl, weight);
+			c->_score[lit_num] += weight;
+		}
+
+		// The clause now depends on its last true literal
+		else if(w->_true_num[cl] == 1 && (other = true_lit_of(w, cl, -1, lit_assign)) >= 0)
+			c->_score[other] -= weight;
+	}
+
+	// Configuration checking: the neighbours of lit_num may be
+	// flipped again, while lit_num itself may not.
+	for(int i = w->_occ_start[lit_num * 2]; i < w->_occ_start[lit_num * 2 + 2]; i++)
+	{
+		int *clause = _clause_of(w, w->_occ[i]);
+
+		for(int j = 0; j < _len_of(w, w->_occ[i]); j++)
+			c->_conf_changed[_lit_var(clause[j])] = 1;
+	}
+
+	c->_conf_changed[lit_num] = 0;
+	c->_flip_time[lit_num] = c->_steps++;
+
+	for(int i = w->_occ_start[lit_num * 2]; i < w->_occ_start[lit_num * 2 + 2]; i++)
+		update_clause_ccd(w, w->_occ[i]);
+
+	update_ccd(c, lit_num);
+}
+
+// Set up the clause weighting search as the method of the solver w
+void cw_create(walk_solver *w, cw_data *c)
+{
+	c->_clause_weight = (int *) malloc(w->_m * sizeof(int));
+	c->_score = (int *) malloc(w->_n * sizeof(int));
+	c->_conf_changed = (char *) malloc(w->_n * sizeof(char));
+	c->_flip_time = (long *) malloc(w->_n * sizeof(long));
+	c->_ccd_lits = (int *) malloc(w->_n * sizeof(int));
+	c->_ccd_pos = (int *) malloc(w->_n * sizeof(int));
+	c->_local_minima = 0;
+	c->_smoothings = 0;
+	w->_data = c;
+}
+
+void cw_destroy(walk_solver *w, cw_data *c)
+{
+	free(c->_clause_weight);
+	free(c->_score); free(c->_conf_changed); free(c->_flip_time);
+	free(c->_ccd_lits); free(c->_ccd_pos);
+	w->_data = NULL;
+}
+
+// The main body of the clause weighting local search
+void cwls(walk_solver *w, problem *pb, char *outfname)
+{
+	cw_data c;
+
+	if(w->_c > 0)
+	{
+		printf("CWLS does not weight cardinality constraints, WalkSAT is used instead\n");
+		walksat(w, pb, outfname);
+		return;
+	}
+
+	cw_create(w, &c);
+
+	local_search(w, pb, (local_method) {"CWLS", cw_pick_lit, cw_start, cw_flipped}, outfname);
+
+	printf("Weight increases: %ld\n", c._local_minima);
+	printf("Smoothings: %ld\n", c._smoothings);
+
+	cw_destroy(w, &c);
+}
@@ -2,11 +2,18 @@
     Header file containing the DPLL implementation, as described in the links below.
     This is a recursive version of the algorithm.
 
-    In order for this method to be used, the user has to call the dpll_satisfaction
-    function, passing in it the file containing the SAT problem, described in the CNF
-    format and the name of the output file, the user wants the solution to the problem
-    to be stored (note that it writes on the file, not appends).
+    All the state of a solve is kept in a dpll_solver struct (and the state
+    of the search of each component in a dpll_search struct), so that many
+    problems can be solved in the same process, at the same time. In order
+    for this method to be used, the user has to call dpll_defaults, change
+    the parameters (_jobs, _phase, _hint, _time_limit and _proof) and call
+    dpll_create, with a problem (see load_problem). Then dpll_satisfaction
+    solves it and writes the solution in the output file (see write_model),
+    or dpll_solve solves it without any output. dpll_destroy frees the
+    solver.
     The two files, have the same format as the ones from the bcsp.c file.
+    Unless preprocessing is unset, the problem is first made smaller (see
+    preprocess.h), so the clauses do not all have K literals.
 
 	Input File:
 	1st row: N M K
@@ -17,7 +24,7 @@
 	solve the problem (with 1 for true and -1 for false). The first integer corresponds
 	to P1, the second to P2 etc.
 
-    The algorithm's pseudo code can be found here: 
+    The algorithm's pseudo code can be found here:
     https://github.com/aimacode/aima-pseudocode/blob/master/md/DPLL-Satisfiable.md,
     while the below link was also used for the final implementation:
     https://www.cs.miami.edu/home/geoff/Courses/CSC648-12S/Content/DPLL.shtml
@@ -27,580 +34,1751 @@
     Note: Some helper functions, originate from the bcsp.c file, but have been
 		  modifiied for the needs of the DPLL algorithm.
 
+    The problem is split into components, groups of clauses that share no
+    symbol with the clauses of the other groups, and dpll solves each of
+    them on its own, so a hard component does not make the search go back
+    over the easy ones. The components are solved in parallel, by _jobs
+    threads (0 for the number of CPUs).
+
+    The cardinality constraints (see cnf.h) are propagated with counters of
+    their true and false literals, kept by unset and set like the situation
+    of the clauses. A constraint with more true literals than its bound is
+    false, and when it is at its bound, its unassigned literals are made
+    false, like the literal of a unit clause. The problem is only solved
+    (empty) when no assignment of the unassigned symbols can make a
+    constraint false, and the symbols of the constraints are never pure,
+    as making a literal of an at most constraint true is not free.
+
+    With _enumerate set, dpll does not stop at the first model: it counts
+    (and writes) the models of the assignment that satisfies the problem
+    and backtracks, as if it had failed, until the whole search tree was
+    visited. The unassigned symbols of such an assignment are free, so it
+    is a cube of 2 ^ free models, and the cubes of different leaves of the
+    tree never share a model, as every decision tries both truth values
+    and the units and the constraints only remove assignments without a
+    model. Pure symbols are not assigned, as that skips models. The models
+    are written as the cubes (with 0 for the free symbols) or one by one,
+    from a single search of the whole problem, while the counting keeps
+    the components and multiplies their counts (see count.h).
+
+    When _proof is set, the clauses dpll learns are written to it (see
+    proof.h), so that an answer of no solution can be checked. When both
+    truth values of a decision failed, the decisions before it cannot all
+    be true, and the clause of their opposites is implied by unit
+    propagation, through the clauses of the two failed branches, which are
+    then deleted. The last one is the empty clause. The pure symbols are
+    not assigned then, as that keeps only some of the solutions, and a
+    failed pure symbol does not prove that the decisions before it failed.
+
     More on the Documentation
 
     Kefsenidis Paraskevas, 2023
 */
 
+#include <pthread.h>
+#include <stdatomic.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <time.h>
+#include <unistd.h>
+#include "interrupt.h"
+#include "checkpoint.h"
+#include "count.h"
+#include "literal.h"
+#include "preprocess.h"
 
 // For backtracing in the dpll algorithm, when the current assignment
-// does not statisfy some clause
-#define _backtrack(sym) set(*sym); sym->_assigned = 0;
+// does not statisfy some clause. The literal lit was assigned true.
+#define _backtrack(s, lit) _unassign(s, lit); set(s, lit); (s)->_backtracks++;
 
-// Defines whether a literal is negative and the symbol false or
-// the literal positive and the symbol true
-#define _lit_truth(sym, lit) ((lit > 0 && sym._truth_val) ||    \
-                               lit < 0 && !sym._truth_val)
+// Assign a truth value of true to the literal lit (and false to !lit)
+#define _assign(s, lit) (s)->_lit_val[lit] = 1; (s)->_lit_val[_lit_neg(lit)] = 0;
+#define _unassign(s, lit) (s)->_lit_val[lit] = 0; (s)->_lit_val[_lit_neg(lit)] = 0;
 
-int K;      // The number of literals in a disjunctive clause
-int M;      // The nuumber of disjunctive clauses in the CNF clause
-int N;      // The total number of Pi literals used.
+// If the symbol has been assigned a truth value or not
+#define _assigned(s, var) ((s)->_lit_val[(var) * 2] | (s)->_lit_val[(var) * 2 + 1])
 
-// See clause struct
+// See the clause arrays
 enum situation
 {
     SET = 1,
     UNSET = 0
 };
 
-// Information about symbols 
-typedef struct symbol
+// What a solve looks for
+enum dpll_enumeration
+{
+    DPLL_ONE_MODEL = 0,
+    DPLL_ALL_MODELS = 1,            // Every model, written one by one
+    DPLL_ALL_CUBES = 2,             // Every model, written as cubes
+    DPLL_COUNT = 3                  // Only the number of models
+};
+
+// How the search of a problem (or of a component) ended
+enum dpll_result
 {
-    int _id;                 // Symbols Pi are defined by i, which we declare as id
-    int *_in_clauses;        // The clauses the symbol is in
-    int *_in_clauses_loc;    // The position of the symbol in the corresponding clause
-    int _truth_val;          // The symbol's truth value
-    int _assigned;           // If the symbol has been assigned a truth value or not
-} symbol;
+    DPLL_SAT = 0,
+    DPLL_UNSAT = 1,
+    DPLL_STOPPED = 2
+};
 
-// Struct for clause information. 
-typedef struct clause
+// The state of the search of a problem
+typedef struct dpll_search
 {
+    int _n;     // The total number of Pi literals used.
+    int _m;     // The nuumber of disjunctive clauses in the CNF clause
+    int _k;     // The number of literals in the longest disjunctive clause
+
+    /*
+        The clauses of the problem are stored in flat arrays, one clause after
+        the other, so that the clauses are contiguous in memory. The literals of
+        clause i are _literals[_clause_lit_start[i]] up to
+        _literals[_clause_lit_start[i + 1] - 1] (as codes, see literal.h), as the
+        clauses of a preprocessed problem have different lengths. The position
+        of each literal in _literals is also its position in _lit_situation, that
+        tracks if it is set (1) or unset (0), and _lit_clause holds its clause.
+        _clause_situation[i] tracks if clause i is set (1) or unset (0).
+    */
     int *_literals;
-    int *_lit_situation;        // Tracks which literals in the clause are set (1) or unset (0)
-    int _clause_situation;      // If clause is set (1) or unset (0)
-} clause;
-/*
-    UNSET clauses, are clauses that are deleted because 
-    they are no longer false, while SET clauses, are clauses
-    that have a false value. Note that UNSET clauses are ignored
-    when searching for a symbol, on which to assign a truth value.
-    
-    UNSET literals on the other hand, are literals deleted from a
-    clause, because their not occurance has a truth value that
-    returns true. Set literals, are literals with their symbol assigned
-    a truth value, so that they return true. So if symbol P1 is assigned
-    a truth value of 1 then the literal P1 will be SET, while the literal
-    !P1 will be UNSET.
-*/
+    int *_clause_lit_start;
+    int *_lit_clause;
+    unsigned char *_lit_situation;
+    unsigned char *_clause_situation;
+    /*
+        UNSET clauses, are clauses that are deleted because
+        they are no longer false, while SET clauses, are clauses
+        that have a false value. Note that UNSET clauses are ignored
+        when searching for a symbol, on which to assign a truth value.
+
+        UNSET literals on the other hand, are literals deleted from a
+        clause, because their not occurance has a truth value that
+        returns true. Set literals, are literals with their symbol assigned
+        a truth value, so that they return true. So if symbol P1 is assigned
+        a truth value of 1 then the literal P1 will be SET, while the literal
+        !P1 will be UNSET.
+    */
+
+    /*
+        The truth values of the literals, indexed by their code. _lit_val[lit] is
+        1 if the symbol of lit is assigned and lit is true, so both literals of
+        an unassigned symbol are 0.
+    */
+    unsigned char *_lit_val;
+
+    /*
+        Occurrence lists of the literals. The positions (in the _literals array)
+        where the literal with code l appears are
+        _lit_occ[_lit_occ_start[l]] up to _lit_occ[_lit_occ_end[l] - 1]. The
+        lists of dpll_build are one after the other, but a list can also be
+        moved and have room after its end, so that clauses can be added to a
+        search (see incremental.h).
+    */
+    int *_lit_occ_start;
+    int *_lit_occ_end;
+    int *_lit_occ;
+
+    /*
+        The cardinality constraints, stored as in the cnf struct, with the
+        number of true (_card_true) and false (_card_false) literals of each
+        one, and their occurrence lists, like the ones of the clauses
+        (_card_occ holds the constraints, not the positions).
+    */
+    int _c;
+    int *_card_lits;
+    int *_card_start;
+    int *_card_bound;
+    int *_card_true;
+    int *_card_false;
+    int *_card_occ_start;
+    int *_card_occ;
+
+    int *_sol;                      // The solution found, or the partial assignment when interrupted
+    unsigned char *_phase;          // The truth value each symbol is given first, when it is picked
+
+    // Statistics of the search
+    long _decisions;                // Symbols assigned by pick_first
+    long _unit_props;               // Symbols assigned by find_unit_clause
+    long _pure_props;               // Symbols assigned by find_pure_symbol
+    long _backtracks;               // Assignments that had to be undone
+    int _stopped;                   // Set when the search was interrupted
+    long _calls;                    // Calls of dpll, for checking the time now and then
+
+    atomic_int *_abort;             // Set by another thread to stop the search (NULL if none)
+    double _deadline;               // The wall_time when the search stops (0 for no limit)
+
+    // The proof of unsatisfiability (see proof.h), if _proof._proof is set
+    proof_lines _proof;
+    int *_global;                   // The symbol of the whole problem, of each symbol of the search
+    int *_decided;                  // The decisions (as literals) that lead to the current assignment
+    int _decided_num;
+    int _learned;                   // Set when the last failed decision added the clause of the decisions before it
+
+    // The enumeration of the models (see dpll_found)
+    enum dpll_enumeration _enumerate;
+    FILE *_models;                  // Where the models are written, NULL to only count them
+    model_count _count;             // The models found
+    long _cubes;                    // The satisfying assignments found, each a cube of models
+    long _written;                  // The models written one by one
+    int *_free;                     // The free symbols of a cube
+
+    /*
+        The checkpoints of the solve (see dpll_save_search). The decisions
+        are kept in _decided, as for a proof, and _save is called with them
+        every few minutes, from _next_save on. A resumed search takes the
+        decisions of the checkpoint (_replay) again (see dpll_replay).
+    */
+    void (*_save)(struct dpll_search *s);
+    struct dpll_solver *_solver;
+    int _comp;                      // The component of the search
+    double _next_save;
+    int *_replay;
+    int _replay_num;
+    int _replay_pos;
+
+    /*
+        The decisions a failure depends on, when _reason is set (see
+        dpll_analyze): _reason is the clause that made each symbol a unit,
+        or -1 for the decisions (and for the symbols the caller assigned
+        before the search), and _core marks the decisions that the last
+        failures depend on. A decision that the failure of its first truth
+        value does not depend on fails with the other one too, so it is not
+        tried. The pure symbols are not assigned then, as their failure
+        depends on the clauses other symbols satisfy, and the constraints
+        count as depending on all the decisions. It is not used with a
+        proof or a checkpoint, which keep every decision in _decided.
+    */
+    int *_reason;
+    unsigned char *_core;
+    int *_stack;                    // The symbols dpll_analyze has reached
+    int _false_clause;              // The clause found by false_exists
+    int _unit_clause;               // The clause found by find_unit_clause
+} dpll_search;
+
+// Build the clause arrays and the occurrence lists of the problem f
+void dpll_build(dpll_search *s, cnf *f) {
+	int i;
+
+	memset(s, 0, sizeof(dpll_search));
+	s->_n = f->_n;
+	s->_m = f->_m;
+	s->_k = f->_k;
+	s->_literals = f->_lits;
+	s->_clause_lit_start = f->_start;
 
-clause *clauses;                // The problem clauses in the CNF.
-symbol *symbols;                // The problem's existing symbols. 0 for P1, 1 for P2 etc
-int *sol;                       // The solution found
-
-// The readfile from bcsp.c, but modified, for
-// the needs of the walksat algorithm.
-int dpll_init(char *filename) {
-	int i,j;
-
-	FILE *infile;
-	int err;
-	
-	// Opening the input file
-	infile=fopen(filename,"r");
-	if (infile==NULL) {
-		printf("Cannot open input file. Now exiting...\n");
-		fclose(infile);
-		return -1;
+	// Allocating memory for the sentences...
+	s->_lit_clause = (int *) malloc((s->_clause_lit_start[s->_m] + 1) * sizeof(int));
+	s->_lit_situation = (unsigned char *) malloc((s->_clause_lit_start[s->_m] + 1) * sizeof(unsigned char));
+	s->_clause_situation = (unsigned char *) malloc((s->_m + 1) * sizeof(unsigned char));
+	s->_lit_val = (unsigned char *) calloc(2 * s->_n, sizeof(unsigned char));
+	s->_lit_occ_start = (int *) calloc(2 * s->_n + 1, sizeof(int));
+	s->_lit_occ_end = (int *) malloc((2 * s->_n + 1) * sizeof(int));
+	s->_lit_occ = (int *) malloc((s->_clause_lit_start[s->_m] + 1) * sizeof(int));
+	s->_sol = (int *) calloc(s->_n + 1, sizeof(int));
+	s->_phase = (unsigned char *) malloc((s->_n + 1) * sizeof(unsigned char));
+	memset(s->_phase, 1, s->_n * sizeof(unsigned char));
+
+	// ...and set them
+	for (i=0;i<s->_m;i++)
+	{
+		s->_clause_situation[i] = SET;
+
+		for(int j = s->_clause_lit_start[i]; j < s->_clause_lit_start[i + 1]; j++)
+		{
+			s->_lit_clause[j] = i;
+			s->_lit_situation[j] = SET;
+
+			// Count the occurrences of each literal
+			s->_lit_occ_start[s->_literals[j] + 1]++;
+		}
 	}
 
-	// Reading the number of propositions
-	err=fscanf(infile, "%d", &N);
-	if (err<1) {
-		printf("Cannot read the number of propositions. Now exiting...\n");
-		fclose(infile);
-		return -1;
-	}
+	// Fill the occurrence lists. _lit_occ_start is first moved one position
+	// ahead, so that it can be used as the insertion point of each list.
+	for(i = 0; i < 2 * s->_n; i++)
+		s->_lit_occ_start[i + 1] += s->_lit_occ_start[i];
 
-	if (N<1) {
-		printf("Small number of propositions. Now exiting...\n");
-		fclose(infile);
-		return -1;
-	}
+	for(i = 2 * s->_n; i > 0; i--)
+		s->_lit_occ_start[i] = s->_lit_occ_start[i - 1];
 
-	// Reading the number of sentences
-	err=fscanf(infile, "%d", &M);
-	if (err<1) {
-		printf("Cannot read the number of sentences. Now exiting...\n");
-		fclose(infile);
-		return -1;
-	}
+	for(i = 0; i < s->_clause_lit_start[s->_m]; i++)
+		s->_lit_occ[s->_lit_occ_start[s->_literals[i] + 1]++] = i;
 
-	if (M<1) {
-		printf("Low number of sentences. Now exiting...\n");
-		fclose(infile);
-		return -1;
-	}
+	for(i = 0; i < 2 * s->_n; i++)
+		s->_lit_occ_end[i] = s->_lit_occ_start[i + 1];
 
-	// Reading the number of propositions per sentence
-	err=fscanf(infile, "%d", &K);
-	if (err<1) {
-		printf("Cannot read the number of propositions per sentence. Now exiting...\n");
-		fclose(infile);
-		return -1;
-	}
+	// The cardinality constraints and their occurrence lists, built the same way
+	s->_c = f->_c;
+	s->_card_lits = f->_card_lits;
+	s->_card_start = f->_card_start;
+	s->_card_bound = f->_card_bound;
+	s->_card_true = (int *) calloc(s->_c + 1, sizeof(int));
+	s->_card_false = (int *) calloc(s->_c + 1, sizeof(int));
+	s->_card_occ_start = (int *) calloc(2 * s->_n + 1, sizeof(int));
+	s->_card_occ = (int *) malloc((_card_total(f) + 1) * sizeof(int));
 
-	if (K<2) {
-		printf("Low number of propositions per sentence. Now exiting...\n");
-		fclose(infile);
-		return -1;
-	}
+	for(i = 0; i < _card_total(f); i++)
+		s->_card_occ_start[s->_card_lits[i] + 1]++;
 
-	// Allocating memory for the sentences...
-	clauses = (clause* ) calloc(M, sizeof(clause));
-    symbols = (symbol *) calloc(N, sizeof(symbol));
-    sol = (int *) calloc(N, sizeof(int));
-
-    for(int k = 0; k < N; k++)
-    {
-        symbols[k]._in_clauses = (int *) calloc(M, sizeof(int));
-        symbols[k]._in_clauses_loc = (int *) calloc(M, sizeof(int));
-    }
-
-	// ...and read them
-	for (i=0;i<M;i++)
-    {
-        clauses[i]._literals = (int *) calloc(K, sizeof(int));
-        clauses[i]._lit_situation = (int *) calloc(K, sizeof(int));
-        clauses[i]._clause_situation = SET;
-
-		for(j=0;j<K;j++) {
-			err=fscanf(infile,"%d", &(clauses[i]._literals[j]));
-			if (err<1) {
-				printf("Cannot read the #%d proposition of the #%d sentence. Now exiting...\n",j+1,i+1);
-				fclose(infile);
-				return -1;
-			}
-			if (clauses[i]._literals[j] == 0 || clauses[i]._literals[j] > N || clauses[i]._literals[j] < -N) {
-				printf("Wrong value for the #%d proposition of the #%d sentence. Now exiting...\n",j+1,i+1);
-				fclose(infile);
-				return -1;
-			}
-
-            clauses[i]._lit_situation[j] = SET;
-
-            symbols[abs(clauses[i]._literals[j]) - 1]._id = (abs(clauses[i]._literals[j]) - 1);
-            symbols[abs(clauses[i]._literals[j]) - 1]._in_clauses[i] = 1;
-            symbols[abs(clauses[i]._literals[j]) - 1]._in_clauses_loc[i] = j;
-            symbols[abs(clauses[i]._literals[j]) - 1]._assigned = 0;
-		}
-    }
-	
-	fclose(infile);
+	for(i = 0; i < 2 * s->_n; i++)
+		s->_card_occ_start[i + 1] += s->_card_occ_start[i];
+
+	for(i = 2 * s->_n; i > 0; i--)
+		s->_card_occ_start[i] = s->_card_occ_start[i - 1];
+
+	for(i = 0; i < s->_c; i++)
+		for(int j = s->_card_start[i]; j < s->_card_start[i + 1]; j++)
+			s->_card_occ[s->_card_occ_start[s->_card_lits[j] + 1]++] = i;
+}
 
-	return 0;
+// Free the arrays of dpll_build (but not the problem itself)
+void dpll_free(dpll_search *s)
+{
+	free(s->_lit_clause); free(s->_lit_situation); free(s->_clause_situation);
+	free(s->_lit_val); free(s->_lit_occ_start); free(s->_lit_occ_end); free(s->_lit_occ); free(s->_sol); free(s->_phase);
+	free(s->_card_true); free(s->_card_false); free(s->_card_occ_start); free(s->_card_occ);
+	free(s->_decided); free(s->_free); free(s->_replay);
+	free(s->_reason); free(s->_core); free(s->_stack);
+	count_free(&s->_count);
+	proof_lines_free(&s->_proof);
 }
 
-// Check if all clauses are UNSET, meaning that they are 
-// satisfied, by the current truth value assignment
-int empty(void)
+// Check if all clauses are UNSET, meaning that they are
+// satisfied, by the current truth value assignment, and that
+// the cardinality constraints stay true, whatever the
+// unassigned literals are
+int empty(dpll_search *s)
 {
-    for(int i = 0; i < M; i++)
-        if(clauses[i]._clause_situation == SET)
+    for(int i = 0; i < s->_m; i++)
+        if(s->_clause_situation[i] == SET)
+            return 0;
+
+    // The literals that are not false may all become true
+    for(int i = 0; i < s->_c; i++)
+        if(s->_card_start[i + 1] - s->_card_start[i] - s->_card_false[i] > s->_card_bound[i])
             return 0;
 
     // No clause is SET, so clauses is "empty"
     return 1;
 }
 
-// Checks if there is an unsatisfiable clause, because of the 
-// current assignment. As unsatisfiable, I mean clauses that have 
-// all of their K literals assigned a value, but they remain 
-// unsatisfied.
-int false_exists(void)
+// Checks if a cardinality constraint has more true
+// literals than its bound
+int card_false_exists(dpll_search *s)
 {
-    for(int i = 0; i < M; i++)
-    {   
-        int set_found = 0;          // If it contains a SET literal
+    for(int i = 0; i < s->_c; i++)
+        if(s->_card_true[i] > s->_card_bound[i])
+            return 1;
 
-        // Check only set clauses. We know that unset
-        // clauses are true
-        if(clauses[i]._clause_situation == SET)
-        {
-            for(int j = 0; j < K; j++)
+    return 0;
+}
+
+// Find a cardinality constraint at its bound, with an unassigned
+// literal. The literal is assigned false and its opposite (now true)
+// is returned (-1 if there is no such constraint).
+int find_card_unit(dpll_search *s)
+{
+    for(int i = 0; i < s->_c; i++)
+    {
+        int len = s->_card_start[i + 1] - s->_card_start[i];
+
+        if(s->_card_true[i] < s->_card_bound[i] || s->_card_true[i] + s->_card_false[i] == len)
+            continue;
+
+        for(int j = s->_card_start[i]; j < s->_card_start[i + 1]; j++)
+            if(!_assigned(s, _lit_var(s->_card_lits[j])))
             {
-                // False literals, are unset literals
-                if(clauses[i]._lit_situation[j] == SET) 
-                {
-                    set_found = 1;
-                    break;
-                }
+                int lit = _lit_neg(s->_card_lits[j]);
+
+                _assign(s, lit);
 
+                return lit;
             }
-        
-            // All literals, are assigned and return false  
-            if(!set_found)
-                return 1;
-        }
     }
 
-    // False does not exist
-    return 0; 
+    return -1;
 }
 
-// Unset clauses containing the literal sym and unset the
-// literal !sym
-void unset(symbol sym)
+// Checks if there is an unsatisfiable clause, because of the
+// current assignment. As unsatisfiable, I mean clauses that have
+// all of their literals assigned a value, but they remain
+// unsatisfied.
+int false_exists(dpll_search *s)
 {
-    if(sym._truth_val)
+    for(int i = 0; i < s->_m; i++)
     {
-        // For each clause containing the symbol
-        for(int i = 0; i < M; i++)
-            if(sym._in_clauses[i])
-            {
-                // If the symbol appears as a positive literal in the clause
-                // unset the clause.
-                if(clauses[i]._literals[sym._in_clauses_loc[i]] > 0)
-                    clauses[i]._clause_situation = UNSET;
-
-                // If the symbol appears as a negative literal in the clause
-                // unset the literal.
-                if(clauses[i]._literals[sym._in_clauses_loc[i]] < 0)
-                    clauses[i]._lit_situation[sym._in_clauses_loc[i]] = UNSET;
-            }
-        
-    }
+        int set_found = 0;          // If it contains a SET literal
 
-    // The opposite is done if the truth value is false
-    else
-    {
-        // For each clause containing the symbol
-        for(int i = 0; i < M; i++)
-            if(sym._in_clauses[i])
+        // Check only set clauses. We know that unset
+        // clauses are true
+        if(s->_clause_situation[i] == SET)
+        {
+            // False literals, are unset literals
+            for(int j = s->_clause_lit_start[i]; j < s->_clause_lit_start[i + 1]; j++)
+                set_found |= (s->_lit_situation[j] == SET);
+
+            // All literals, are assigned and return false
+            if(!set_found)
             {
-                // If the symbol appears as a negative literal in the clause
-                // unset the clause.
-                if(clauses[i]._literals[sym._in_clauses_loc[i]] < 0)
-                    clauses[i]._clause_situation = UNSET;
-
-                // If the symbol appears as a positive literal in the clause
-                // unset the literal.
-                if(clauses[i]._literals[sym._in_clauses_loc[i]] > 0)
-                    clauses[i]._lit_situation[sym._in_clauses_loc[i]] = UNSET;
+                s->_false_clause = i;
+                return 1;
             }
+        }
     }
+
+    // False does not exist
+    return 0;
 }
 
 // Count how many literals in a clause return a truth value
-// of true. Needed by set function, as we can only set an 
+// of true. Needed by set function, as we can only set an
 // entire clause if its truth value depends solely one literal
-int true_lit_num(int clause_num)
+int true_lit_num(dpll_search *s, int clause_num)
 {
     int true_lits = 0;
 
-    for(int i = 0; i < K; i++)
-        if(symbols[abs(clauses[clause_num]._literals[i]) - 1]._assigned)
-            if(_lit_truth(symbols[abs(clauses[clause_num]._literals[i]) - 1], clauses[clause_num]._literals[i]))
-                true_lits++;
+    for(int j = s->_clause_lit_start[clause_num]; j < s->_clause_lit_start[clause_num + 1]; j++)
+        true_lits += s->_lit_val[s->_literals[j]];
 
     return true_lits;
 }
 
-// Reverse of unset function. Set clauses containing
-// the literal sym and set the literal !sym
-void set(symbol sym)
+// Find unitary clauses. A clause is considered unitary
+// when all its literals return false, exept for one
+// that it is not yet assigned. The literal is assigned
+// true and returned (-1 if there is no unitary clause).
+int find_unit_clause(dpll_search *s)
 {
-    if(sym._truth_val)
+    // For each SET clause, check which is unitary
+    for(int i = 0; i < s->_m; i++)
     {
-        // For each clause containing the symbol
-        for(int i = 0; i < M; i++)
-            if(sym._in_clauses[i])
+        int set_lit_num = 0;        // Number of set literals in clause
+        int lit = 0;                // The only literal of the unitary clause (if there is)
+
+        if(s->_clause_situation[i] == SET)
+        {
+            // A clause can be unitary if all, but one of its
+            // literals is both unassigned and SET, while the rest,
+            // are UNSET and of course assigned
+            for(int j = s->_clause_lit_start[i]; j < s->_clause_lit_start[i + 1]; j++)
             {
-                // If the symbol appears as a positive literal in the clause
-                // set the clause.
-                if(clauses[i]._literals[sym._in_clauses_loc[i]] > 0 && true_lit_num(i) == 1)
-                    clauses[i]._clause_situation = SET;
-
-                // If the symbol appears as a negative literal in the clause
-                // set the literal.
-                if(clauses[i]._literals[sym._in_clauses_loc[i]] < 0)
-                    clauses[i]._lit_situation[sym._in_clauses_loc[i]] = SET;
+                int is_set = (s->_lit_situation[j] == SET);
+
+                set_lit_num += is_set;
+                lit = ((is_set) ? (s->_literals[j]) : (lit));
             }
-    }
 
-    // The opposite is done if the truth value is false
-    else
-    {
-        // For each clause containing the symbol
-        for(int i = 0; i < M; i++)
-            if(sym._in_clauses[i])
+            // All but one literals are UNSET
+            if(set_lit_num == 1)
             {
-                // If the symbol appears as a negative literal in the clause
-                // set the clause.
-                if(clauses[i]._literals[sym._in_clauses_loc[i]] < 0 && true_lit_num(i) == 1)
-                    clauses[i]._clause_situation = SET;
-
-                // If the symbol appears as a positive literal in the clause
-                // set the literal.
-                if(clauses[i]._literals[sym._in_clauses_loc[i]] > 0)
-                    clauses[i]._lit_situation[sym._in_clauses_loc[i]] = SET;
+                _assign(s, lit);
+                s->_unit_clause = i;
+
+                return lit;
             }
+        }
     }
+
+    return -1;
+}
+
+// Unset clauses containing the literal lit (which was assigned
+// true) and unset the literal !lit
+void unset(dpll_search *s, int lit)
+{
+    // For each clause containing the literal, unset the clause.
+    for(int i = s->_lit_occ_start[lit]; i < s->_lit_occ_end[lit]; i++)
+        s->_clause_situation[s->_lit_clause[s->_lit_occ[i]]] = UNSET;
+
+    // For each clause containing the opposite literal, unset the literal.
+    for(int i = s->_lit_occ_start[_lit_neg(lit)]; i < s->_lit_occ_end[_lit_neg(lit)]; i++)
+        s->_lit_situation[s->_lit_occ[i]] = UNSET;
+
+    // Count the literal in the constraints, as true, and its opposite, as false
+    for(int i = s->_card_occ_start[lit]; i < s->_card_occ_start[lit + 1]; i++)
+        s->_card_true[s->_card_occ[i]]++;
+
+    for(int i = s->_card_occ_start[_lit_neg(lit)]; i < s->_card_occ_start[_lit_neg(lit) + 1]; i++)
+        s->_card_false[s->_card_occ[i]]++;
+}
+
+// Reverse of unset function. Set clauses containing
+// the literal lit and set the literal !lit. It is called
+// after the truth value of lit was unassigned.
+void set(dpll_search *s, int lit)
+{
+    // For each clause containing the literal, set the clause,
+    // if no other literal keeps it satisfied.
+    for(int i = s->_lit_occ_start[lit]; i < s->_lit_occ_end[lit]; i++)
+        if(true_lit_num(s, s->_lit_clause[s->_lit_occ[i]]) == 0)
+            s->_clause_situation[s->_lit_clause[s->_lit_occ[i]]] = SET;
+
+    // For each clause containing the opposite literal, set the literal.
+    for(int i = s->_lit_occ_start[_lit_neg(lit)]; i < s->_lit_occ_end[_lit_neg(lit)]; i++)
+        s->_lit_situation[s->_lit_occ[i]] = SET;
+
+    for(int i = s->_card_occ_start[lit]; i < s->_card_occ_start[lit + 1]; i++)
+        s->_card_true[s->_card_occ[i]]--;
+
+    for(int i = s->_card_occ_start[_lit_neg(lit)]; i < s->_card_occ_start[_lit_neg(lit) + 1]; i++)
+        s->_card_false[s->_card_occ[i]]--;
 }
 
 // Selects the first not assigned symbol
-symbol *pick_first(void)
+int pick_first(dpll_search *s)
 {
-    for(int i = 0; i < N; i++)
-        if(!symbols[i]._assigned)
-            return &(symbols[i]);
+    for(int i = 0; i < s->_n; i++)
+        if(!_assigned(s, i))
+            return i;
 
-    return NULL;
+    return -1;
 }
 
-// Returns the first occurence of the symbol's
-// literal in clauses
-int *first_occurence(symbol sym)
+// Returns 1 if the literal appears in a SET clause
+int in_set_clause(dpll_search *s, int lit)
 {
-    for(int i = 0; i < M; i++)
-        if(clauses[i]._clause_situation == SET)
-            if(sym._in_clauses[i])
-                return &(clauses[i]._literals[sym._in_clauses_loc[i]]);
-    
-    return NULL;
+    for(int i = s->_lit_occ_start[lit]; i < s->_lit_occ_end[lit]; i++)
+        if(s->_clause_situation[s->_lit_clause[s->_lit_occ[i]]] == SET)
+            return 1;
+
+    return 0;
 }
 
 // Find a pure symbol in the clauses. Pure is a symbol
 // that is only encoutered as a positive xor a negative
-// literal
-symbol *find_pure_symbol(void)
+// literal. The literal of the symbol that appears is
+// assigned true and returned (-1 if there is no pure symbol).
+int find_pure_symbol(dpll_search *s)
 {
-    int *lit;                           // To check if the symbol appears as both negative and positive
-
-    for(int i = 0; i < N; i++)
+    for(int i = 0; i < s->_n; i++)
     {
-        int pure = 1;                                   // Start by stating that the symbol is true
-
-        // We want to find unassigned symbols
-        if(!symbols[i]._assigned)
+        // We want to find unassigned symbols, that are in no constraint
+        if(!_assigned(s, i) && s->_card_occ_start[i * 2] == s->_card_occ_start[i * 2 + 2])
         {
-            lit = first_occurence(symbols[i]);                        
-
-            if(lit == NULL)
-                continue;
-
-            for(int j = 0; j < M; j++)
-                if(clauses[j]._clause_situation == SET && symbols[i]._in_clauses[j])           // Only SET clauses
-                    if(*lit != clauses[j]._literals[symbols[i]._in_clauses_loc[j]])     // Literal changed (from positive to negative or vice versa)
-                    {
-                        pure = 0;
-                        break;
-                    }   
-
-            // Return the symbol, after making some calculations, like
-            // assigning a truth value
-            if(pure)
+            int pos = in_set_clause(s, i * 2);         // Only SET clauses
+            int neg = in_set_clause(s, i * 2 + 1);
+
+            if(pos != neg)
             {
-                symbols[i]._truth_val = ((*lit > 0) ? (1) : (0));
-                symbols[i]._assigned = 1;
+                int lit = ((pos) ? (i * 2) : (i * 2 + 1));
+
+                _assign(s, lit);
 
-                return &(symbols[i]);
+                return lit;
             }
         }
     }
 
     // No pure symbol
-    return NULL;
+    return -1;
 }
 
-// Find unitary clauses. A clause is considered unitary
-// when all its literals return false, exept for one
-// that it is not yet assigned.
-symbol *find_unit_clause(void)
+// Store the current assignment in _sol, with 1 for true and -1 for
+// false. Unassigned symbols are stored as 0 if partial is set (they
+// can take any value in a solution, so they are stored as false otherwise).
+void store_sol(dpll_search *s, int partial)
 {
-    // For each SET clause, check which is unitary
-    for(int i = 0; i < M; i++)
+    for(int i = 0; i < s->_n; i++)
     {
-        int set_in_clause = 0;                              // If a SET literal exists in the clause
-        int set_lit_num = 0;                                // Number of set literals in clause
-        int lit;                                            // The only literal of the unitary clause (if there is)
+        if(!_assigned(s, i))
+            s->_sol[i] = ((partial) ? (0) : (-1));
+        else
+            s->_sol[i] = ((s->_lit_val[i * 2]) ? (1) : (-1));
+    }
+}
 
-        if(clauses[i]._clause_situation == SET)
-        {
-            // A clause can be unitary if all, but one of its
-            // literals is both unassigned and SET, while the rest,
-            // are UNSET and of course assigned
-            for(int j = 0; j < K; j++)
-            {
-                // Note that SET also means assigned and true or not assigned literals
-                // In this, the not assigned literals.
-                if(clauses[i]._lit_situation[j] == SET)
-                {
-                    set_in_clause = 1;
-                    set_lit_num++;
-
-                    if(set_lit_num == 1)
-                        lit = clauses[i]._literals[j];
-                    else
-                        break;
-                }
-            }
-            
-            // All but one literals are SET
-            if(set_in_clause && set_lit_num == 1)
-            {
-                symbols[abs(lit) - 1]._truth_val = ((lit > 0) ? (1) : (0));
-                symbols[abs(lit) - 1]._assigned = 1;
+// Write a model, or a cube (with 0 for the free symbols), on a line of its own
+void print_model_line(FILE *out, int *model, int n)
+{
+    for(int i = 0; i < n; i++)
+        fputs(((model[i] == 1) ? ("1 ") : ((model[i] == -1) ? ("-1 ") : ("0 "))), out);
 
-                return &(symbols[abs(lit) - 1]);
-            }
+    fputc('\n', out);
+}
+
+// All the clauses are satisfied by the current assignment, while the
+// models are enumerated. The unassigned symbols are free, so the 2 ^ free
+// models of the cube are counted and written (the cube itself, or every
+// model, with the free symbols counting in binary from all false).
+void dpll_found(dpll_search *s)
+{
+    int free_num = 0;
+    int i;
+
+    s->_cubes++;
+    store_sol(s, 1);
+
+    for(i = 0; i < s->_n; i++)
+        if(s->_sol[i] == 0)
+            s->_free[free_num++] = i;
+
+    count_add_pow2(&s->_count, free_num);
+
+    if(s->_models == NULL)
+        return;
+
+    if(s->_enumerate == DPLL_ALL_CUBES)
+    {
+        print_model_line(s->_models, s->_sol, s->_n);
+        return;
+    }
+
+    for(i = 0; i < free_num; i++)
+        s->_sol[s->_free[i]] = -1;
+
+    while(1)
+    {
+        print_model_line(s->_models, s->_sol, s->_n);
+        s->_written++;
+
+        for(i = 0; i < free_num && s->_sol[s->_free[i]] == 1; i++)
+            s->_sol[s->_free[i]] = -1;
+
+        if(i == free_num)
+            break;
+
+        s->_sol[s->_free[i]] = 1;
+
+        // A cube can have more models than can ever be written, so
+        // the writing stops like the search
+        if(interrupted || (s->_deadline > 0 && (s->_written & 1023) == 0 && wall_time() >= s->_deadline))
+        {
+            s->_stopped = 1;
+            break;
         }
     }
+}
 
-    return NULL;
+// Add (or delete) the clause of the opposites of the decisions
+// to the proof, as the decisions cannot all be true
+void dpll_proof_decisions(dpll_search *s, char type)
+{
+    proof_begin(&s->_proof, type, s->_decided_num);
+
+    for(int i = 0; i < s->_decided_num; i++)
+    {
+        int lit = _lit_neg(s->_decided[i]);
+
+        proof_lit(&s->_proof, s->_global[_lit_var(lit)] * 2 + _lit_sign(lit));
+    }
+
+    proof_end(&s->_proof);
+}
+
+// The last decision failed (a clause became false, through unit
+// propagation, or both truth values of a later decision failed, which
+// already added the clause)
+void dpll_proof_failed(dpll_search *s)
+{
+    if(!s->_learned)
+        dpll_proof_decisions(s, 'a');
+
+    s->_learned = 0;
+}
+
+// Both truth values of the last decision failed, so the decisions
+// before it cannot all be true
+void dpll_proof_backtrack(dpll_search *s)
+{
+    int lit = s->_decided[s->_decided_num - 1];
+
+    dpll_proof_failed(s);
+
+    s->_decided_num--;
+    dpll_proof_decisions(s, 'a');
+    s->_decided_num++;
+
+    // The clauses of the two truth values are implied by the new one
+    dpll_proof_decisions(s, 'd');
+    s->_decided[s->_decided_num - 1] = _lit_neg(lit);
+    dpll_proof_decisions(s, 'd');
+
+    s->_decided_num--;
+    s->_learned = 1;
+}
+
+// A resumed search takes the decisions of its checkpoint again, in their
+// order, as they lead to the assignment it had reached. A decision that
+// was on the opposite of the phase literal lit of the symbol var had
+// already failed with lit, so it is not tried again. Returns 1 when the
+// search goes on with the opposite of lit.
+int dpll_replay(dpll_search *s, int var, int lit)
+{
+    int saved;
+
+    if(s->_replay_pos >= s->_replay_num)
+        return 0;
+
+    saved = s->_replay[s->_replay_pos++];
+
+    // (a checkpoint that does not lead here is not replayed any further)
+    if(_lit_var(saved) != var)
+    {
+        s->_replay_num = s->_replay_pos = 0;
+        return 0;
+    }
+
+    return saved != lit;
+}
+
+// Reach the symbol var from a false clause (see dpll_analyze): a decision
+// is marked, and a unit is added to the stack (marked 2), to be followed
+void dpll_reach(dpll_search *s, int var, int *num)
+{
+    if(s->_reason[var] < 0)
+        s->_core[var] = 1;
+
+    else if(s->_core[var] == 0)
+    {
+        s->_core[var] = 2;
+        s->_stack[(*num)++] = var;
+    }
+}
+
+// The clause is false: mark the decisions it depends on in _core. Its
+// literals are false by decisions, or by units, whose clauses are false
+// but for them, so the decisions are found by following those clauses.
+void dpll_analyze(dpll_search *s, int clause)
+{
+    int num = 0;
+
+    for(int j = s->_clause_lit_start[clause]; j < s->_clause_lit_start[clause + 1]; j++)
+        dpll_reach(s, _lit_var(s->_literals[j]), &num);
+
+    for(int i = 0; i < num; i++)
+    {
+        int unit = s->_reason[s->_stack[i]];
+
+        for(int j = s->_clause_lit_start[unit]; j < s->_clause_lit_start[unit + 1]; j++)
+            dpll_reach(s, _lit_var(s->_literals[j]), &num);
+    }
+
+    for(int i = 0; i < num; i++)
+        s->_core[s->_stack[i]] = 0;
+}
+
+// Mark all the decisions, for a failure that is not explained by a clause
+void dpll_depend_all(dpll_search *s)
+{
+    for(int i = 0; i < s->_n; i++)
+        if(_assigned(s, i) && s->_reason[i] < 0)
+            s->_core[i] = 1;
 }
 
 // The dpll algorithm implementation, based on this site:
 // https://www.cs.miami.edu/home/geoff/Courses/CSC648-12S/Content/DPLL.shtml
-// and primarily on this site: 
+// and primarily on this site:
 // https://github.com/aimacode/aima-pseudocode/blob/master/md/DPLL-Satisfiable.md
 // (also on the book)
-int dpll(void)
+int dpll(dpll_search *s)
 {
-    symbol *sym;
+    int lit;
+    int var;
+    int late = 0;
 
-    if(empty())
-        return 1;
+    // The clock is read now and then, for the deadline and the checkpoints
+    if((s->_deadline > 0 || s->_save != NULL) && (++s->_calls & 1023) == 0)
+    {
+        double now = wall_time();
+
+        late = (s->_deadline > 0 && now >= s->_deadline);
+
+        if(s->_save != NULL && now >= s->_next_save && !late)
+            s->_save(s);
+    }
+
+    // On a signal (or when another thread stops the search, or at the
+    // deadline), keep the assignment reached so far and let every level of
+    // the recursion fail, until dpll returns
+    if(s->_stopped || interrupted || (s->_abort != NULL && atomic_load_explicit(s->_abort, memory_order_relaxed)) || late)
+    {
+        if(!s->_stopped)
+            store_sol(s, 1);
+
+        s->_stopped = 1;
+
+        return 0;
+    }
+
+    // When enumerating, the search goes on, as if the assignment had failed
+    if(empty(s))
+    {
+        if(s->_enumerate == DPLL_ONE_MODEL)
+            return 1;
+
+        dpll_found(s);
+        return 0;
+    }
+
+    if(false_exists(s))
+    {
+        if(s->_reason != NULL)
+            dpll_analyze(s, s->_false_clause);
+
+        return 0;
+    }
+
+    if(card_false_exists(s))
+    {
+        if(s->_reason != NULL)
+            dpll_depend_all(s);
 
-    if(false_exists())
         return 0;
+    }
 
-    // If there exists a pure symbol or a unit clause,
-    // select them
-    if((sym = find_pure_symbol()) != NULL)
+    // If there exists a pure symbol or a unit clause, select them (not
+    // the pure symbols, for a proof, an enumeration or the _reason)
+    if(s->_proof._proof == NULL && s->_enumerate == DPLL_ONE_MODEL && s->_reason == NULL && (lit = find_pure_symbol(s)) >= 0)
     {
-        unset(*sym);
+        s->_pure_props++;
+        unset(s, lit);
 
-        if(dpll())
+        if(dpll(s))
             return 1;
         else
         {
-            _backtrack(sym);
+            _backtrack(s, lit);
             return 0;
         }
     }
 
-    if((sym = find_unit_clause()) != NULL)
+    // (the literals a constraint at its bound makes false are units too)
+    s->_unit_clause = -1;
+
+    if((lit = find_unit_clause(s)) >= 0 || (lit = find_card_unit(s)) >= 0)
     {
-        unset(*sym);
+        s->_unit_props++;
+        unset(s, lit);
 
-        if(dpll())
+        if(s->_reason != NULL)
+            s->_reason[_lit_var(lit)] = s->_unit_clause;
+
+        if(dpll(s))
             return 1;
         else
         {
-            _backtrack(sym);
+            _backtrack(s, lit);
             return 0;
         }
     }
 
     // Or any other symbol
-    sym = pick_first();
+    var = pick_first(s);
 
     // The problem remains unsatisfiable and no more
     // literals available for assgnment
-    if(sym == NULL)
+    if(var < 0)
+    {
+        if(s->_reason != NULL)
+            dpll_depend_all(s);
+
         return 0;
+    }
 
-    // Assign true
-    sym->_truth_val = 1;
-    sym->_assigned = 1;
-    unset(*sym);
+    s->_decisions++;
 
-    if(dpll())
-        return 1;
-    
-    // Assignment failed
-    else
-    {
-        // Reset the clause to previous state and
-        // assign false to the symbol
-        _backtrack(sym);
+    if(s->_reason != NULL)
+        s->_reason[var] = -1;
+
+    // Assign the phase of the symbol (true, unless it was set otherwise),
+    // unless a resumed search already tried it
+    lit = _true_lit(var, s->_phase[var]);
 
-        // Assign false
-        sym->_truth_val = 0;
-        sym->_assigned = 1;
-        unset(*sym);
+    if(s->_decided != NULL)
+        s->_decided[s->_decided_num++] = lit;
 
-        if(dpll())
+    if(!dpll_replay(s, var, lit))
+    {
+        _assign(s, lit);
+        unset(s, lit);
+
+        if(dpll(s))
             return 1;
-        
-        else
+
+        // Assignment failed, so reset the clauses to their previous state
+        _backtrack(s, lit);
+
+        if(s->_proof._proof != NULL && !s->_stopped)
+            dpll_proof_failed(s);
+
+        // A failure that does not depend on the decision happens with
+        // the other truth value as well
+        if(s->_reason != NULL && !s->_stopped)
         {
-            _backtrack(sym);
-            return 0;
+            if(s->_core[var] != 1)
+                return 0;
+
+            s->_core[var] = 0;
         }
     }
+
+    // Assign the opposite truth value
+    lit = _lit_neg(lit);
+    _assign(s, lit);
+    unset(s, lit);
+
+    if(s->_decided != NULL && !s->_stopped)
+        s->_decided[s->_decided_num - 1] = lit;
+
+    if(dpll(s))
+        return 1;
+
+    _backtrack(s, lit);
+
+    if(s->_reason != NULL)
+        s->_core[var] = 0;
+
+    // (the decision is taken off the decisions, by the proof or here)
+    if(s->_proof._proof != NULL && !s->_stopped)
+        dpll_proof_backtrack(s);
+    else if(s->_decided != NULL && !s->_stopped)
+        s->_decided_num--;
+
+    return 0;
 }
 
-// Writes solution to a file. False as -1 and true as 1
-int write_to_file(char *outfname)
+// Prints a solution
+void print_sol(int *sol, int n)
 {
-    FILE *outf;
-    int error;
+    for(int i = 0; i < n; i++)
+    {
+        if(sol[i] == 1)
+            printf("P%d=%s ", i + 1, "true");
+        else
+            printf("P%d=%s ", i + 1, "false");
+    }
+}
 
-    outf = fopen(outfname, "w");
+// The state of the solve of a whole problem, split in components
+typedef struct dpll_solver
+{
+    cnf *_cnf;                      // The (preprocessed) problem
+    int _jobs;                      // Components solved at the same time, 0 for the number of CPUs
+    unsigned char *_phase;          // The phase of each symbol, NULL to try true first
+    int *_hint;                     // A model (1 or -1 for each symbol) to be checked first, NULL if none
+    proof *_proof;                  // The proof of unsatisfiability being written, NULL if none
+    double _time_limit;             // Seconds of wall clock time for the whole solve (0 for no limit)
+    double _deadline;               // The wall_time when the solve stops (0 for no limit)
+
+    /*
+        The enumeration of the models, when _enumerate is set. The models are
+        written to _models (by a single search, as the problem is then a single
+        component, with all the symbols), unless they are only counted. The
+        count is the product of the counts of the components, times 2 for each
+        symbol that is not in any clause.
+    */
+    enum dpll_enumeration _enumerate;
+    FILE *_models;
+    model_count _count;
+    long _cubes;
+    long _written;
+
+    /*
+        The components of the problem. Symbols are joined with union-find, when
+        they appear in the same clause (or cardinality constraint). _comp_of_var
+        is -1 for the symbols that are not in any clause or constraint, as any
+        truth value satisfies them.
+    */
+    int _comp_num;
+    int *_comp_of_var;              // The component of each symbol (N)
+    int *_comp_of_clause;           // The component of each clause (M)
+    int *_comp_of_card;             // The component of each cardinality constraint
+
+    /*
+        The symbols, clauses and constraints of each component, in their
+        order: the ones of component c are _comp_vars[_comp_var_start[c]] up
+        to _comp_vars[_comp_var_start[c + 1] - 1], and the same for the
+        others. A component is built from these alone, so building all of
+        them takes one pass over the problem, however many there are.
+        _local_of_var is the number of each symbol in its component, which
+        each search sets for the symbols of its own component only.
+    */
+    int *_comp_var_start;
+    int *_comp_vars;
+    int *_comp_clause_start;
+    int *_comp_clauses;
+    int *_comp_card_start;
+    int *_comp_cards;
+    int *_local_of_var;
+
+    /*
+        The threads take the components in order, through _next. When a
+        component is unsatisfiable, _abort stops the searches of the others.
+        The model of each component is copied in _model, where the symbols
+        that are not in any clause are 0, and the statistics are added up,
+        under the _lock.
+    */
+    int _next;
+    atomic_int _abort;
+    pthread_mutex_t _lock;
+    enum dpll_result _result;
+    int _unsat_comp;                // The unsatisfiable component, when _result is DPLL_UNSAT
+    int *_model;
+
+    // Statistics of all the components
+    long _decisions;
+    long _unit_props;
+    long _pure_props;
+    long _backtracks;
+    int _reused;                    // Components satisfied by the _hint, without a search
+
+    /*
+        The checkpoints (see dpll_write_checkpoint), when _checkpoint is set.
+        _comp_state is DPLL_SOLVED for the components whose model is in
+        _model, and DPLL_SAVED for the ones whose decisions (as literals of the
+        whole problem) are in _comp_path. The other components start from the
+        beginning on a resume.
+    */
+    checkpoint *_checkpoint;
+    char *_comp_state;
+    int **_comp_path;
+    int *_comp_path_num;
+} dpll_solver;
+
+// The state of a component in a checkpoint
+enum dpll_comp_state
+{
+    DPLL_NOT_SAVED = 0,
+    DPLL_SOLVED = 1,
+    DPLL_SAVED = 2
+};
 
-    if(outf == NULL)
+// The root of the set of a symbol, in the union-find parent array
+int find_root(int *parent, int var)
+{
+    while(parent[var] != var)
     {
-        fprintf(stderr, "An error occured opening the file!");
+        parent[var] = parent[parent[var]];      // Path halving
+        var = parent[var];
+    }
+
+    return var;
+}
 
+// Join the symbols of the len literals of lits, in the union-find parent array
+void join_symbols(int *parent, int *lits, int len)
+{
+    int root = find_root(parent, _lit_var(lits[0]));
+
+    for(int j = 1; j < len; j++)
+    {
+        int other = find_root(parent, _lit_var(lits[j]));
+
+        if(other != root)
+            parent[other] = root;
+    }
+}
+
+// The component of the len literals of lits (joined by join_symbols),
+// numbered when it is first seen. Their symbols are set to it.
+int component_of(dpll_solver *d, int *parent, int *id, int *lits, int len)
+{
+    int root = find_root(parent, _lit_var(lits[0]));
+
+    if(id[root] < 0)
+        id[root] = d->_comp_num++;
+
+    for(int j = 0; j < len; j++)
+        d->_comp_of_var[_lit_var(lits[j])] = id[root];
+
+    return id[root];
+}
+
+// Group the num items of comp_of (the component of each one, -1 for
+// none) by their component, keeping their order, with a counting sort.
+// Returns the start of each group in *items (comp_num + 1 of them).
+int *group_by_component(int *comp_of, int num, int comp_num, int **items)
+{
+    int *start = (int *) calloc(comp_num + 2, sizeof(int));
+
+    *items = (int *) malloc((num + 1) * sizeof(int));
+
+    for(int i = 0; i < num; i++)
+        if(comp_of[i] >= 0)
+            start[comp_of[i] + 2]++;
+
+    // start[c + 1] is then the insertion point of component c
+    for(int c = 2; c <= comp_num; c++)
+        start[c] += start[c - 1];
+
+    for(int i = 0; i < num; i++)
+        if(comp_of[i] >= 0)
+            (*items)[start[comp_of[i] + 1]++] = i;
+
+    return start;
+}
+
+// Find the components of the problem of the solver
+void find_components(dpll_solver *d)
+{
+    cnf *f = d->_cnf;
+    int *parent = (int *) malloc((f->_n + 1) * sizeof(int));
+    int *id = (int *) malloc((f->_n + 1) * sizeof(int));
+
+    for(int i = 0; i < f->_n; i++)
+    {
+        parent[i] = i;
+        id[i] = -1;
+    }
+
+    // The models are written from a search of the whole problem
+    if(d->_enumerate == DPLL_ALL_MODELS || d->_enumerate == DPLL_ALL_CUBES)
+        for(int i = 1; i < f->_n; i++)
+            parent[i] = 0;
+
+    for(int i = 0; i < f->_m; i++)
+        join_symbols(parent, f->_lits + f->_start[i], _clause_len(f, i));
+
+    for(int i = 0; i < f->_c; i++)
+        join_symbols(parent, f->_card_lits + f->_card_start[i], _card_len(f, i));
+
+    d->_comp_num = 0;
+    d->_comp_of_var = (int *) malloc((f->_n + 1) * sizeof(int));
+    d->_comp_of_clause = (int *) malloc((f->_m + 1) * sizeof(int));
+    d->_comp_of_card = (int *) malloc((f->_c + 1) * sizeof(int));
+
+    for(int i = 0; i < f->_n; i++)
+        d->_comp_of_var[i] = -1;
+
+    // Number the components in the order of their first clause (and
+    // then of their first constraint, for the ones without clauses)
+    for(int i = 0; i < f->_m; i++)
+        d->_comp_of_clause[i] = component_of(d, parent, id, f->_lits + f->_start[i], _clause_len(f, i));
+
+    for(int i = 0; i < f->_c; i++)
+        d->_comp_of_card[i] = component_of(d, parent, id, f->_card_lits + f->_card_start[i], _card_len(f, i));
+
+    // (even the symbols that are not in any clause, and when there are no clauses)
+    if(d->_enumerate == DPLL_ALL_MODELS || d->_enumerate == DPLL_ALL_CUBES)
+    {
+        d->_comp_num = 1;
+
+        for(int i = 0; i < f->_n; i++)
+            d->_comp_of_var[i] = 0;
+    }
+
+    d->_comp_var_start = group_by_component(d->_comp_of_var, f->_n, d->_comp_num, &d->_comp_vars);
+    d->_comp_clause_start = group_by_component(d->_comp_of_clause, f->_m, d->_comp_num, &d->_comp_clauses);
+    d->_comp_card_start = group_by_component(d->_comp_of_card, f->_c, d->_comp_num, &d->_comp_cards);
+    d->_local_of_var = (int *) malloc((f->_n + 1) * sizeof(int));
+
+    free(parent); free(id);
+}
+
+// If the _hint satisfies all the clauses (and constraints) of the component comp, copy
+// it to the model of the solver and return 1
+int hint_satisfies(dpll_solver *d, int comp)
+{
+    cnf *f = d->_cnf;
+
+    for(int c = d->_comp_clause_start[comp]; c < d->_comp_clause_start[comp + 1]; c++)
+    {
+        int i = d->_comp_clauses[c], sat = 0;
+
+        for(int j = f->_start[i]; j < f->_start[i + 1] && !sat; j++)
+            sat = (d->_hint[_lit_var(f->_lits[j])] == ((_lit_sign(f->_lits[j])) ? (-1) : (1)));
+
+        if(!sat)
+            return 0;
+    }
+
+    for(int c = d->_comp_card_start[comp]; c < d->_comp_card_start[comp + 1]; c++)
+    {
+        int i = d->_comp_cards[c], true_lits = 0;
+
+        for(int j = f->_card_start[i]; j < f->_card_start[i + 1]; j++)
+            true_lits += (d->_hint[_lit_var(f->_card_lits[j])] == ((_lit_sign(f->_card_lits[j])) ? (-1) : (1)));
+
+        if(true_lits > f->_card_bound[i])
+            return 0;
+    }
+
+    pthread_mutex_lock(&d->_lock);
+
+    for(int v = d->_comp_var_start[comp]; v < d->_comp_var_start[comp + 1]; v++)
+        d->_model[d->_comp_vars[v]] = d->_hint[d->_comp_vars[v]];
+
+    d->_reused++;
+
+    pthread_mutex_unlock(&d->_lock);
+
+    return 1;
+}
+
+/*
+    The checkpoint of a solve holds the state of each component: solved,
+    with its model, or the decisions its search had reached. The decisions
+    are all the search needs to go on, as the units and the pure symbols
+    follow from them, and the other truth value of every decision that is
+    not on its phase (the first value tried) has already failed. Nothing is
+    learned, so there are no clauses to keep. The phases are kept as well,
+    since the decisions mean nothing with other phases. The statistics
+    count the search after the resume only.
+
+    Checkpoint: the number of components (int), the phases (N bits), the
+    models of the solved components (N bits, 0 for the other symbols), and
+    the state of each component (a char), followed by the number of its
+    decisions and the decisions (ints), for the saved ones.
+*/
+
+// Write the checkpoint of the solve. The lock must be held.
+void dpll_write_checkpoint(dpll_solver *d)
+{
+    checkpoint *ck = d->_checkpoint;
+    int n = d->_cnf->_n;
+    unsigned char *vals = (unsigned char *) malloc((n + 1) * sizeof(unsigned char));
+
+    checkpoint_begin(ck, "DPLL");
+    checkpoint_put(ck, &d->_comp_num, sizeof(int));
+
+    for(int i = 0; i < n; i++)
+        vals[i] = ((d->_phase != NULL) ? (d->_phase[i]) : (1));
+
+    checkpoint_put_bits(ck, vals, n, 1);
+
+    for(int i = 0; i < n; i++)
+        vals[i] = (d->_comp_of_var[i] >= 0 && d->_comp_state[d->_comp_of_var[i]] == DPLL_SOLVED && d->_model[i] == 1);
+
+    checkpoint_put_bits(ck, vals, n, 1);
+
+    for(int i = 0; i < d->_comp_num; i++)
+    {
+        checkpoint_put(ck, &d->_comp_state[i], 1);
+
+        if(d->_comp_state[i] == DPLL_SAVED)
+        {
+            checkpoint_put(ck, &d->_comp_path_num[i], sizeof(int));
+            checkpoint_put(ck, d->_comp_path[i], d->_comp_path_num[i] * sizeof(int));
+        }
+    }
+
+    checkpoint_write(ck);
+    free(vals);
+}
+
+// Keep the decisions of the search in its component. The lock must be held.
+void dpll_keep_path(dpll_search *s)
+{
+    dpll_solver *d = s->_solver;
+    int comp = s->_comp;
+
+    // A resumed search keeps the decisions of the checkpoint,
+    // until it has taken all of them again
+    if(s->_replay_pos < s->_replay_num)
+        return;
+
+    d->_comp_path[comp] = (int *) realloc(d->_comp_path[comp], (s->_decided_num + 1) * sizeof(int));
+    d->_comp_path_num[comp] = s->_decided_num;
+    d->_comp_state[comp] = DPLL_SAVED;
+
+    for(int i = 0; i < s->_decided_num; i++)
+        d->_comp_path[comp][i] = s->_global[_lit_var(s->_decided[i])] * 2 + _lit_sign(s->_decided[i]);
+}
+
+// The _save of the searches: keep the decisions of the search and write
+// the checkpoint, with the last decisions kept by the other searches
+void dpll_save_search(dpll_search *s)
+{
+    dpll_solver *d = s->_solver;
+
+    pthread_mutex_lock(&d->_lock);
+    dpll_keep_path(s);
+    dpll_write_checkpoint(d);
+    pthread_mutex_unlock(&d->_lock);
+
+    s->_next_save = wall_time() + d->_checkpoint->_every;
+}
+
+// Read the checkpoint of the solve into the states of the components
+// (and the models of the solved ones into _model). Returns 1 if it was read.
+int dpll_load(dpll_solver *d)
+{
+    checkpoint *ck = d->_checkpoint;
+    int n = d->_cnf->_n;
+    unsigned char *phase = (unsigned char *) malloc((n + 1) * sizeof(unsigned char));
+    unsigned char *model = (unsigned char *) malloc((n + 1) * sizeof(unsigned char));
+    int comp_num, ok, same_phase = 1;
+
+    if(!checkpoint_read(ck, "DPLL", 0))
+    {
+        free(phase); free(model);
         return 0;
     }
 
-    for(int i = 0; i < N; i++)
+    ok = (checkpoint_get(ck, &comp_num, sizeof(int)) == 0 && comp_num == d->_comp_num &&
+          checkpoint_get_bits(ck, phase, n, 1) == 0 && checkpoint_get_bits(ck, model, n, 1) == 0);
+
+    for(int i = 0; i < d->_comp_num && ok; i++)
+    {
+        ok = (checkpoint_get(ck, &d->_comp_state[i], 1) == 0 && d->_comp_state[i] >= DPLL_NOT_SAVED &&
+              d->_comp_state[i] <= DPLL_SAVED);
+
+        if(ok && d->_comp_state[i] == DPLL_SAVED)
+        {
+            ok = (checkpoint_get(ck, &d->_comp_path_num[i], sizeof(int)) == 0 && d->_comp_path_num[i] >= 0 &&
+                  d->_comp_path_num[i] <= n);
+
+            if(ok)
+            {
+                d->_comp_path[i] = (int *) malloc((d->_comp_path_num[i] + 1) * sizeof(int));
+                ok = (checkpoint_get(ck, d->_comp_path[i], d->_comp_path_num[i] * sizeof(int)) == 0);
+            }
+
+            for(int j = 0; ok && j < d->_comp_path_num[i]; j++)
+                ok = (d->_comp_path[i][j] >= 0 && d->_comp_path[i][j] < 2 * n &&
+                      d->_comp_of_var[_lit_var(d->_comp_path[i][j])] == i);
+        }
+    }
+
+    ok = ok && checkpoint_done(ck);
+
+    // The decisions were taken with the phases of the checkpoint
+    for(int i = 0; i < n && ok; i++)
+        same_phase &= (phase[i] == ((d->_phase != NULL) ? (d->_phase[i]) : (1)));
+
+    if(ok && !same_phase && d->_phase == NULL)
+    {
+        printf("The checkpoint in %s was written with other phases, the search starts from the beginning\n", ck->_file);
+        ok = -1;
+    }
+
+    else if(!ok)
+        printf("The checkpoint in %s is damaged, the search starts from the beginning\n", ck->_file);
+
+    if(ok == 1)
     {
-        if(symbols[i]._truth_val)
-            fprintf(outf, "%d ", 1);
+        if(d->_phase != NULL)
+            memcpy(d->_phase, phase, n * sizeof(unsigned char));
+
+        for(int i = 0; i < n; i++)
+            if(d->_comp_of_var[i] >= 0 && d->_comp_state[d->_comp_of_var[i]] == DPLL_SOLVED)
+                d->_model[i] = ((model[i]) ? (1) : (-1));
+
+        printf("Resuming DPLL from the checkpoint %s\n", ck->_file);
+    }
+
+    else
+    {
+        memset(d->_comp_state, DPLL_NOT_SAVED, d->_comp_num * sizeof(char));
+        memset(d->_comp_path_num, 0, d->_comp_num * sizeof(int));
+    }
+
+    checkpoint_free(ck);
+    free(phase); free(model);
+
+    return ok == 1;
+}
+
+// Solve the component comp with dpll and store the truth values of its
+// symbols in the model of the solver (the partial assignment if the
+// search was interrupted)
+enum dpll_result solve_component(dpll_solver *d, int comp)
+{
+    cnf *f = d->_cnf;
+    cnf sub;
+    dpll_search s;
+    int *local = d->_local_of_var;          // The symbols of the component, renumbered
+    int *global = d->_comp_vars + d->_comp_var_start[comp];
+    int *clauses = d->_comp_clauses + d->_comp_clause_start[comp];
+    int *cards = d->_comp_cards + d->_comp_card_start[comp];
+    int len = 0, card_len = 0;
+    enum dpll_result result;
+
+    // A component that the hint already satisfies is not searched,
+    // and neither is one that was solved before the checkpoint
+    if((d->_hint != NULL && hint_satisfies(d, comp)) ||
+       (d->_checkpoint != NULL && d->_comp_state[comp] == DPLL_SOLVED))
+        return DPLL_SAT;
+
+    // Build the problem of the component. The symbols keep their order.
+    sub._n = d->_comp_var_start[comp + 1] - d->_comp_var_start[comp];
+    sub._m = d->_comp_clause_start[comp + 1] - d->_comp_clause_start[comp];
+    sub._k = f->_k;
+    sub._c = d->_comp_card_start[comp + 1] - d->_comp_card_start[comp];
+
+    for(int i = 0; i < sub._n; i++)
+        local[global[i]] = i;
+
+    for(int i = 0; i < sub._m; i++)
+        len += _clause_len(f, clauses[i]);
+
+    for(int i = 0; i < sub._c; i++)
+        card_len += _card_len(f, cards[i]);
+
+    sub._start = (int *) malloc((sub._m + 1) * sizeof(int));
+    sub._lits = (int *) malloc((len + 1) * sizeof(int));
+    sub._card_start = (int *) malloc((sub._c + 1) * sizeof(int));
+    sub._card_lits = (int *) malloc((card_len + 1) * sizeof(int));
+    sub._card_bound = (int *) malloc((sub._c + 1) * sizeof(int));
+    len = 0;
+    card_len = 0;
+
+    for(int i = 0; i < sub._m; i++)
+    {
+        sub._start[i] = len;
+
+        for(int j = f->_start[clauses[i]]; j < f->_start[clauses[i] + 1]; j++)
+            sub._lits[len++] = local[_lit_var(f->_lits[j])] * 2 + _lit_sign(f->_lits[j]);
+    }
+
+    sub._start[sub._m] = len;
+
+    for(int i = 0; i < sub._c; i++)
+    {
+        sub._card_bound[i] = f->_card_bound[cards[i]];
+        sub._card_start[i] = card_len;
+
+        for(int j = f->_card_start[cards[i]]; j < f->_card_start[cards[i] + 1]; j++)
+            sub._card_lits[card_len++] = local[_lit_var(f->_card_lits[j])] * 2 + _lit_sign(f->_card_lits[j]);
+    }
+
+    sub._card_start[sub._c] = card_len;
+
+    dpll_build(&s, &sub);
+    s._abort = &d->_abort;
+    s._deadline = d->_deadline;
+
+    if(d->_proof != NULL)
+    {
+        proof_lines_init(&s._proof, d->_proof);
+        s._global = global;
+        s._decided = (int *) malloc((sub._n + 1) * sizeof(int));
+    }
+
+    if(d->_checkpoint != NULL)
+    {
+        s._save = dpll_save_search;
+        s._solver = d;
+        s._comp = comp;
+        s._next_save = wall_time() + d->_checkpoint->_every;
+        s._global = global;
+        s._decided = (int *) malloc((sub._n + 1) * sizeof(int));
+
+        // (the saved decisions are literals of the whole problem)
+        if(d->_comp_state[comp] == DPLL_SAVED)
+        {
+            s._replay_num = d->_comp_path_num[comp];
+            s._replay = (int *) malloc((s._replay_num + 1) * sizeof(int));
+
+            for(int i = 0; i < s._replay_num; i++)
+                s._replay[i] = local[_lit_var(d->_comp_path[comp][i])] * 2 + _lit_sign(d->_comp_path[comp][i]);
+        }
+    }
+
+    if(d->_phase != NULL)
+        for(int i = 0; i < sub._n; i++)
+            s._phase[i] = d->_phase[global[i]];
+
+    if(d->_enumerate != DPLL_ONE_MODEL)
+    {
+        s._enumerate = d->_enumerate;
+        s._models = d->_models;
+        s._free = (int *) malloc((sub._n + 1) * sizeof(int));
+    }
+
+    if(dpll(&s))
+    {
+        store_sol(&s, 0);
+        result = DPLL_SAT;
+    }
+
+    // An enumeration always fails in the end, after the models
+    else if(!s._stopped && !count_is_zero(&s._count))
+        result = DPLL_SAT;
+
+    else
+        result = ((s._stopped) ? (DPLL_STOPPED) : (DPLL_UNSAT));
+
+    // The empty clause, unless the first decision added it
+    if(result == DPLL_UNSAT && s._proof._proof != NULL)
+        dpll_proof_failed(&s);
+
+    pthread_mutex_lock(&d->_lock);
+
+    // On DPLL_STOPPED, dpll has already stored the partial assignment
+    if(result != DPLL_UNSAT)
+        for(int i = 0; i < sub._n; i++)
+            d->_model[global[i]] = s._sol[i];
+
+    // A stopped search keeps the decisions it had reached, for the checkpoint
+    if(d->_checkpoint != NULL && result == DPLL_SAT)
+        d->_comp_state[comp] = DPLL_SOLVED;
+    else if(d->_checkpoint != NULL && result == DPLL_STOPPED)
+        dpll_keep_path(&s);
+
+    d->_decisions += s._decisions;
+    d->_unit_props += s._unit_props;
+    d->_pure_props += s._pure_props;
+    d->_backtracks += s._backtracks;
+
+    if(d->_enumerate != DPLL_ONE_MODEL)
+    {
+        count_mul(&d->_count, &s._count);
+        d->_cubes += s._cubes;
+        d->_written += s._written;
+    }
+
+    pthread_mutex_unlock(&d->_lock);
+
+    dpll_free(&s);
+    free_cnf(&sub);
+
+    return result;
+}
+
+// The body of each thread: solve components, until there are no more
+// or until one of them is unsatisfiable
+void *dpll_worker(void *arg)
+{
+    dpll_solver *d = (dpll_solver *) arg;
+
+    while(1)
+    {
+        int comp;
+        enum dpll_result result;
+
+        pthread_mutex_lock(&d->_lock);
+        comp = d->_next++;
+        pthread_mutex_unlock(&d->_lock);
+
+        if(comp >= d->_comp_num || atomic_load(&d->_abort))
+            break;
+
+        // The components that never start are not solved
+        if(interrupted || (d->_deadline > 0 && wall_time() >= d->_deadline))
+            result = DPLL_STOPPED;
         else
-            fprintf(outf, "%d ", -1);
+            result = solve_component(d, comp);
+
+        pthread_mutex_lock(&d->_lock);
+
+        if(result == DPLL_UNSAT && d->_result != DPLL_UNSAT)
+        {
+            d->_result = DPLL_UNSAT;
+            d->_unsat_comp = comp;
+            atomic_store(&d->_abort, 1);
+        }
+
+        else if(result == DPLL_STOPPED && d->_result == DPLL_SAT)
+            d->_result = DPLL_STOPPED;
+
+        pthread_mutex_unlock(&d->_lock);
     }
 
-    return 1;
+    return NULL;
+}
+
+// The number of threads of the solve
+int dpll_threads(dpll_solver *d)
+{
+    int jobs = ((d->_jobs > 0) ? (d->_jobs) : ((int) sysconf(_SC_NPROCESSORS_ONLN)));
+
+    if(jobs > d->_comp_num)
+        jobs = d->_comp_num;
+
+    return ((jobs > 1) ? (jobs) : (1));
 }
 
-// Prints a solution 
-void print_sol(void)
+// Solve the problem of the solver. The model (1 for true and -1 for false,
+// with the symbols that are not in any clause false) or the partial
+// assignment, if the search was interrupted, is left in _model.
+enum dpll_result dpll_solve(dpll_solver *d)
 {
-    for(int i = 0; i < N; i++)
+    int jobs = dpll_threads(d);
+    pthread_t *threads = (pthread_t *) malloc(jobs * sizeof(pthread_t));
+    int started = 0;
+
+    d->_next = 0;
+    d->_result = DPLL_SAT;
+    d->_decisions = d->_unit_props = d->_pure_props = d->_backtracks = 0;
+    d->_reused = 0;
+    d->_unsat_comp = -1;
+    d->_deadline = ((d->_time_limit > 0) ? (wall_time() + d->_time_limit) : (0));
+    atomic_store(&d->_abort, 0);
+    count_set(&d->_count, 1);
+    d->_cubes = d->_written = 0;
+
+    for(int i = 0; i < d->_cnf->_n; i++)
+        d->_model[i] = 0;
+
+    if(d->_checkpoint != NULL)
     {
-        if(symbols[i]._truth_val)
-            printf("P%d=%s ", i + 1, "true");
+        d->_comp_state = (char *) calloc(d->_comp_num + 1, sizeof(char));
+        d->_comp_path = (int **) calloc(d->_comp_num + 1, sizeof(int *));
+        d->_comp_path_num = (int *) calloc(d->_comp_num + 1, sizeof(int));
+
+        if(d->_checkpoint->_resume)
+            dpll_load(d);
+    }
+
+    // This thread solves components too, so with one job no thread is started
+    for(; started < jobs - 1; started++)
+        if(pthread_create(&threads[started], NULL, dpll_worker, d) != 0)
+            break;
+
+    dpll_worker(d);
+
+    for(int i = 0; i < started; i++)
+        pthread_join(threads[i], NULL);
+
+    free(threads);
+
+    // A stopped solve is resumed from its last state, while the
+    // checkpoint of a solve that is over is of no use
+    if(d->_checkpoint != NULL)
+    {
+        if(d->_result == DPLL_STOPPED)
+            dpll_write_checkpoint(d);
         else
-            printf("P%d=%s ", i + 1, "false");
+            checkpoint_remove(d->_checkpoint);
+
+        for(int i = 0; i < d->_comp_num; i++)
+            free(d->_comp_path[i]);
+
+        free(d->_comp_state); free(d->_comp_path); free(d->_comp_path_num);
+    }
+
+    // Any truth value of a symbol that is not in any clause doubles the models
+    if(d->_enumerate != DPLL_ONE_MODEL)
+    {
+        model_count free_models;
+        int free_num = 0;
+
+        for(int i = 0; i < d->_cnf->_n; i++)
+            free_num += (d->_comp_of_var[i] < 0);
+
+        memset(&free_models, 0, sizeof(model_count));
+        count_add_pow2(&free_models, free_num);
+        count_mul(&d->_count, &free_models);
+        count_free(&free_models);
     }
+
+    if(d->_result == DPLL_SAT)
+        for(int i = 0; i < d->_cnf->_n; i++)
+            if(d->_model[i] == 0)
+                d->_model[i] = -1;
+
+    return d->_result;
+}
+
+// Set the parameters of the solve to their defaults
+void dpll_defaults(dpll_solver *d)
+{
+    memset(d, 0, sizeof(dpll_solver));
+}
+
+// Prepare the solve of the problem f, which must stay
+// allocated while the solver is used
+void dpll_create(dpll_solver *d, cnf *f)
+{
+    d->_cnf = f;
+    d->_model = (int *) malloc((f->_n + 1) * sizeof(int));
+    pthread_mutex_init(&d->_lock, NULL);
+
+    find_components(d);
+}
+
+// Free the arrays of dpll_create (but not the problem itself)
+void dpll_destroy(dpll_solver *d)
+{
+    free(d->_comp_of_var); free(d->_comp_of_clause); free(d->_comp_of_card); free(d->_model);
+    free(d->_comp_var_start); free(d->_comp_vars); free(d->_comp_clause_start); free(d->_comp_clauses);
+    free(d->_comp_card_start); free(d->_comp_cards); free(d->_local_of_var);
+    count_free(&d->_count);
+    pthread_mutex_destroy(&d->_lock);
 }
 
 // The dpll algorithm constructor. It is a wrapper around the dpll
-// algorithm, used for initialization and printing the solution if found
-void dpll_satisfaction(char *infname, char *outfname)
+// algorithm, used for solving the problem pb and printing the solution if found
+void dpll_satisfaction(dpll_solver *d, problem *pb, char *outfname)
 {
-    int err;
+    int verified;
+    enum dpll_result result;
     clock_t t1, t2;
 
-    // Initialize all DPLL variables
-    err = dpll_init(infname);
-
-    if(err)
-        exit(-1);
-   
-    // Call DPLL main body
+    // Call DPLL main body (the time of all the threads is counted)
     t1 = clock();
-    int found = dpll();
+    result = dpll_solve(d);
     t2 = clock();
 
-    if(found)
+    if(result == DPLL_SAT)
     {
-        printf("\n\nSolution found with DPLL!\n"); print_sol(); printf("\n");
-		printf("Time spent: %f secs\n",((float) t2 - t1) / CLOCKS_PER_SEC);
-        write_to_file(outfname);
+        // The symbols removed by the preprocessing are set as well
+        verified = finish_model(pb, d->_model);
+
+        printf("\n\nSolution found with DPLL!\n"); print_sol(d->_model, d->_cnf->_n); printf("\n");
+        write_model(d->_model, d->_cnf->_n, outfname, pb->_number);
+        printf("Solution verified: %s\n", ((verified) ? ("yes") : ("NO")));
+    }
+
+    else if(result == DPLL_STOPPED)
+    {
+        printf("\n\nDPLL was %s, the partial assignment was written...\n", ((interrupted) ? ("interrupted") : ("stopped by the time limit")));
+        // The partial assignment has 0 for the unassigned symbols
+        write_model(d->_model, d->_cnf->_n, outfname, pb->_number);
     }
 
     else
     {
         printf("\n\nThere is no solution to the problem...\n");
-		printf("Time spent: %f secs\n",((float) t2 - t1) / CLOCKS_PER_SEC);
+        write_model(NULL, 0, outfname, pb->_number);
+        pb->_answer = ANSWER_UNSAT;
+    }
+
+    printf("Components: %d (%d solved at the same time)\n", d->_comp_num, dpll_threads(d));
+    printf("Time spent: %f secs\n",((float) t2 - t1) / CLOCKS_PER_SEC);
+    printf("Decisions: %ld\n", d->_decisions);
+    printf("Unit propagations: %ld\n", d->_unit_props);
+    printf("Pure symbols: %ld\n", d->_pure_props);
+    printf("Backtracks: %ld\n", d->_backtracks);
+}
+
+// Enumerate (or count, see _enumerate) the models of the problem of the
+// solver, writing them (or their number) to the output file
+void dpll_enumeration(dpll_solver *d, char *outfname)
+{
+    enum dpll_result result;
+    char *found = ((d->_enumerate == DPLL_COUNT) ? ("counted") : ("written"));
+    FILE *outf;
+    clock_t t1, t2;
+
+    outf = fopen(outfname, "w");
+
+    if(outf == NULL)
+    {
+        fprintf(stderr, "An error occured opening the file!");
+        return;
     }
-}
\ No newline at end of file
+
+    d->_models = ((d->_enumerate == DPLL_COUNT) ? (NULL) : (outf));
+
+    t1 = clock();
+    result = dpll_solve(d);
+    t2 = clock();
+
+    if(result == DPLL_SAT)
+        printf("\n\nAll the models were %s with DPLL!\n", found);
+    else if(result == DPLL_UNSAT)
+        printf("\n\nThere is no solution to the problem...\n");
+    else
+        printf("\n\nDPLL was %s, the models found so far were %s...\n", ((interrupted) ? ("interrupted") : ("stopped by the time limit")), found);
+
+    // When the search stopped, the models are the ones of the cubes found
+    printf("Models: "); count_print(stdout, &d->_count); printf("\n");
+    printf("Cubes: %ld\n", d->_cubes);
+
+    if(d->_enumerate == DPLL_ALL_MODELS)
+        printf("Models written: %ld\n", d->_written);
+
+    // The output file of the counting has the number of models
+    if(d->_enumerate == DPLL_COUNT)
+        count_print(outf, &d->_count);
+
+    fclose(outf);
+    d->_models = NULL;
+
+    printf("Components: %d (%d solved at the same time)\n", d->_comp_num, dpll_threads(d));
+    printf("Time spent: %f secs\n",((float) t2 - t1) / CLOCKS_PER_SEC);
+    printf("Decisions: %ld\n", d->_decisions);
+    printf("Unit propagations: %ld\n", d->_unit_props);
+    printf("Backtracks: %ld\n", d->_backtracks);
+}
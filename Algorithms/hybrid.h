@@ -0,0 +1,119 @@
+/*
+	Header file containing a hybrid of the WalkSAT and the DPLL algorithms.
+	It must be included after the walksat.h and the dpll.h files, as it
+	uses both of them, on the same (preprocessed) problem, read once.
+
+	WalkSAT searches first, with the budget set by max_flips, max_tries and
+	time_limit. The time limit is the one of the whole solve, so DPLL only
+	has the time WalkSAT left (and when none is left, the best assignment
+	is written, as by WalkSAT alone). If WalkSAT finds a solution, the
+	solution is written. Otherwise
+	its best assignment (the one with the fewest unsatisfied clauses)
+	becomes the phase of DPLL: when DPLL picks a symbol, it first tries the
+	truth value the symbol has in that assignment, instead of always true.
+	An assignment that leaves only a few clauses unsatisfied usually agrees
+	with a solution on most of the symbols, so DPLL reaches the solution
+	with fewer decisions, while it still proves the problem unsatisfiable
+	when there is no solution.
+
+	The user needs to create a walk_solver and a dpll_solver for the same
+	problem and then call the hybrid function, with the output file.
+
+	With checkpoints (see checkpoint.h), WalkSAT writes its own until it is
+	over, and then DPLL writes its own, with the phases. A resumed search
+	whose checkpoint is the one of DPLL does not run WalkSAT again.
+
+	Link used:
+	https://www.cs.ubc.ca/~hoos/Publ/FerLisHoo04.pdf
+
+	Kefsenidis Paraskevas, 2023.
+*/
+
+// Set the phases of DPLL to the best WalkSAT assignment (the caller
+// frees d->_phase after the solve)
+void hybrid_phase(walk_solver *w, dpll_solver *d)
+{
+	d->_phase = (unsigned char *) malloc(w->_n * sizeof(unsigned char));
+
+	for(int i = 0; i < w->_n; i++)
+		d->_phase[i] = w->_best_assign[i * 2];
+}
+
+// The main body of the hybrid algorithm
+void hybrid(walk_solver *w, dpll_solver *d, problem *pb, char *outfname)
+{
+	enum walk_result result;
+	double start = wall_time();
+	clock_t t1, t2;
+
+	// A resumed search that had reached DPLL goes on with it, with
+	// the phases of its checkpoint (see dpll_load)
+	if(d->_checkpoint != NULL && d->_checkpoint->_resume && checkpoint_read(d->_checkpoint, "DPLL", 1))
+	{
+		checkpoint_free(d->_checkpoint);
+		d->_phase = (unsigned char *) malloc((w->_n + 1) * sizeof(unsigned char));
+		memset(d->_phase, 1, w->_n * sizeof(unsigned char));
+
+		dpll_satisfaction(d, pb, outfname);
+
+		free(d->_phase);
+		d->_phase = NULL;
+		return;
+	}
+
+	walk_noise_init(w);
+
+	t1 = clock();
+	result = walk_solve(w, (local_method) {"WalkSAT", pick_lit, NULL, NULL});
+	t2 = clock();
+
+	printf("WalkSAT: %d unsatisfied clauses left (%s, %ld steps, %f secs)\n", w->_best_false,
+		   walk_result_name[result], w->_steps, ((float) t2 - t1) / CLOCKS_PER_SEC);
+
+	// DPLL has the rest of the time limit
+	if(w->_time_limit > 0)
+	{
+		d->_time_limit = w->_time_limit - (wall_time() - start);
+
+		if(d->_time_limit <= 0)
+			result = WALK_TIMEOUT;
+	}
+
+	// A solution is written as by WalkSAT, and so is the best
+	// assignment when the search was interrupted or out of time
+	if(result == WALK_SOLVED || result == WALK_INTERRUPTED || result == WALK_TIMEOUT)
+	{
+		int *model = (int *) malloc(w->_n * sizeof(int));
+		int verified;
+
+		for(int i = 0; i < w->_n; i++)
+			model[i] = ((w->_best_assign[i * 2]) ? (1) : (-1));
+
+		verified = finish_model(pb, model);
+		write_model(model, w->_n, outfname, pb->_number);
+
+		if(result == WALK_SOLVED)
+		{
+			printf("\n\nSolution found with WalkSAT!\n"); display(model, w->_n); printf("\n");
+			printf("Solution verified: %s\n", ((verified) ? ("yes") : ("NO")));
+		}
+
+		else
+			printf("\n\nThe search was %s, the best assignment was written...\n",
+				   ((result == WALK_INTERRUPTED) ? ("interrupted") : ("stopped by the time limit")));
+
+		free(model);
+		return;
+	}
+
+	// Otherwise DPLL starts from the phases of the best assignment
+	// (and from the beginning, as the checkpoint was the one of WalkSAT)
+	if(d->_checkpoint != NULL)
+		d->_checkpoint->_resume = 0;
+
+	hybrid_phase(w, d);
+	dpll_satisfaction(d, pb, outfname);
+
+	free(d->_phase);
+	d->_phase = NULL;
+}
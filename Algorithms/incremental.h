@@ -0,0 +1,418 @@
+/*
+	Header file containing an incremental interface to the DPLL algorithm,
+	for programs that solve many related problems, one after the other.
+	It must be included after the dpll.h file.
+
+	The clauses are added one at a time with inc_add_clause (the literals
+	as in the input file, from -N to N, excluding 0), and the symbols are
+	added with them, so N grows with the largest symbol. inc_solve then
+	solves the clauses added so far, under a set of assumptions (literals
+	that must be true for this solve only). Clauses can still be added
+	after a solve, and the next solve sees them too.
+
+	After a satisfiable solve, inc_value gives the truth value of a literal
+	in the model. After an unsatisfiable one, inc_failed tells whether an
+	assumption was one of the failed assumptions: the ones the refutation
+	of the search used, under which the clauses alone are unsatisfiable.
+	When no assumption is failed, the clauses themselves are
+	unsatisfiable, and every next solve returns DPLL_UNSAT without a
+	search, as clauses are never removed.
+
+	The work of a solve is kept for the next ones:
+	- The search (see dpll_search) is built once, and each clause is added
+	  to its arrays and occurrence lists as it comes, so a solve starts
+	  searching at once, however many clauses there are.
+	- The assumptions are the first decisions of the search, taken before
+	  any other, and the search keeps the unit clause of each literal it
+	  propagates (see dpll_analyze). So when it fails, it knows the
+	  assumptions the failure depends on, and it does not try the other
+	  truth value of a decision that a failure does not depend on.
+	- The clause of the opposites of the failed assumptions follows from
+	  the clauses, so it is learned: it is added to the clauses and stays
+	  for the next solves, which fail at once on the same assumptions.
+	- Each symbol is first given the truth value it had in the last model
+	  (phase saving), so a small change of the problem leads to a search
+	  close to the last solution, and when the last model still satisfies
+	  the clauses and the assumptions, it is the answer, without a search.
+
+	The problem is never preprocessed, as the preprocessing removes symbols
+	that later clauses or assumptions may use, and it is a single search,
+	as the components change when clauses are added.
+
+	In order for this to be used, the user has to call inc_create, add the
+	clauses, call inc_solve as many times as needed and inc_destroy at the
+	end.
+
+	Link used:
+	http://minisat.se/downloads/MiniSat.pdf
+
+	Kefsenidis Paraskevas, 2023
+*/
+
+typedef struct inc_solver
+{
+	cnf _cnf;					// The clauses added so far, and the learned ones
+	int _lits_cap;				// The capacity of _cnf._lits
+	int _start_cap;				// The capacity of _cnf._start
+
+	/*
+		The search of the clauses, kept from solve to solve, with no symbol
+		assigned between the solves. Its arrays have room for _var_cap
+		symbols, _clause_cap clauses and _pos_cap literals. The occurrence
+		list of the literal l has room for _occ_cap[l] positions from its
+		start, and a full one is moved to the end of _lit_occ (after the
+		_occ_num positions used out of _occ_size), with twice the room.
+	*/
+	dpll_search _search;
+	int _var_cap;
+	int _clause_cap;
+	int _pos_cap;
+	int *_occ_cap;
+	int _occ_num;
+	int _occ_size;
+
+	int *_model;				// The last model (1 or -1 for each symbol), valid if _has_model
+	int _has_model;
+	int *_failed;				// The failed assumptions of the last solve (as in the input file)
+	int _failed_num;
+	int _failed_cap;
+	int _unsat;					// Set when the clauses themselves are unsatisfiable
+
+	// Statistics of the last solve
+	long _decisions;
+	long _backtracks;
+	int _reused;				// Set when the last model still satisfied the clauses and the assumptions
+	int _learned;				// Clauses learned from the failed assumptions, by all the solves
+} inc_solver;
+
+// Make room for the symbols up to n
+void inc_grow(inc_solver *s, int n)
+{
+	dpll_search *d = &s->_search;
+	int old = s->_cnf._n;
+
+	if(n <= old)
+		return;
+
+	if(n > s->_var_cap)
+	{
+		int cap = ((2 * s->_var_cap > n) ? (2 * s->_var_cap) : (n));
+
+		d->_lit_val = (unsigned char *) realloc(d->_lit_val, 2 * cap * sizeof(unsigned char));
+		d->_lit_occ_start = (int *) realloc(d->_lit_occ_start, (2 * cap + 1) * sizeof(int));
+		d->_lit_occ_end = (int *) realloc(d->_lit_occ_end, (2 * cap + 1) * sizeof(int));
+		d->_card_occ_start = (int *) realloc(d->_card_occ_start, (2 * cap + 1) * sizeof(int));
+		d->_sol = (int *) realloc(d->_sol, (cap + 1) * sizeof(int));
+		d->_phase = (unsigned char *) realloc(d->_phase, (cap + 1) * sizeof(unsigned char));
+		d->_reason = (int *) realloc(d->_reason, (cap + 1) * sizeof(int));
+		d->_core = (unsigned char *) realloc(d->_core, (cap + 1) * sizeof(unsigned char));
+		d->_stack = (int *) realloc(d->_stack, (cap + 1) * sizeof(int));
+		s->_occ_cap = (int *) realloc(s->_occ_cap, (2 * cap + 1) * sizeof(int));
+		s->_model = (int *) realloc(s->_model, (cap + 1) * sizeof(int));
+		s->_var_cap = cap;
+	}
+
+	// The new symbols are tried true first, as by dpll, and are
+	// false in the last model, as they were in no clause
+	for(int i = old; i < n; i++)
+	{
+		d->_lit_val[i * 2] = d->_lit_val[i * 2 + 1] = 0;
+		d->_phase[i] = 1;
+		d->_core[i] = 0;
+		s->_model[i] = -1;
+	}
+
+	// Their literals have empty lists, and are in no constraint
+	for(int l = 2 * old; l < 2 * n; l++)
+	{
+		d->_lit_occ_start[l] = d->_lit_occ_end[l] = s->_occ_num;
+		s->_occ_cap[l] = 0;
+	}
+
+	for(int l = 2 * old; l <= 2 * n; l++)
+		d->_card_occ_start[l] = 0;
+
+	s->_cnf._n = d->_n = n;
+}
+
+// Add the position pos to the occurrence list of the literal lit
+void inc_push_occ(inc_solver *s, int lit, int pos)
+{
+	dpll_search *d = &s->_search;
+	int len = d->_lit_occ_end[lit] - d->_lit_occ_start[lit];
+
+	if(len == s->_occ_cap[lit])
+	{
+		int cap = ((len > 0) ? (2 * len) : (4));
+
+		if(s->_occ_num + cap > s->_occ_size)
+		{
+			s->_occ_size = 2 * (s->_occ_num + cap);
+			d->_lit_occ = (int *) realloc(d->_lit_occ, s->_occ_size * sizeof(int));
+		}
+
+		memcpy(d->_lit_occ + s->_occ_num, d->_lit_occ + d->_lit_occ_start[lit], len * sizeof(int));
+		d->_lit_occ_start[lit] = s->_occ_num;
+		d->_lit_occ_end[lit] = s->_occ_num + len;
+		s->_occ_cap[lit] = cap;
+		s->_occ_num += cap;
+	}
+
+	d->_lit_occ[d->_lit_occ_end[lit]++] = pos;
+}
+
+// Add a clause of len literals (as codes, at the end of the clauses) to
+// the clauses and to the search
+void inc_push_clause(inc_solver *s, int *codes, int len)
+{
+	dpll_search *d = &s->_search;
+	int m = s->_cnf._m;
+	int end = s->_cnf._start[m];
+	int entries = m + 1;
+
+	for(int i = 0; i < len; i++)
+		push_int(&s->_cnf._lits, &end, &s->_lits_cap, codes[i]);
+
+	push_int(&s->_cnf._start, &entries, &s->_start_cap, end);
+	s->_cnf._m++;
+
+	if(len > s->_cnf._k)
+		s->_cnf._k = len;
+
+	if(m + 1 > s->_clause_cap)
+	{
+		s->_clause_cap = 2 * (m + 1);
+		d->_clause_situation = (unsigned char *) realloc(d->_clause_situation, s->_clause_cap * sizeof(unsigned char));
+	}
+
+	if(end > s->_pos_cap)
+	{
+		s->_pos_cap = 2 * end;
+		d->_lit_clause = (int *) realloc(d->_lit_clause, s->_pos_cap * sizeof(int));
+		d->_lit_situation = (unsigned char *) realloc(d->_lit_situation, s->_pos_cap * sizeof(unsigned char));
+	}
+
+	// (the arrays of the clauses may have moved)
+	d->_literals = s->_cnf._lits;
+	d->_clause_lit_start = s->_cnf._start;
+	d->_m = s->_cnf._m;
+	d->_k = s->_cnf._k;
+	d->_clause_situation[m] = SET;
+
+	for(int j = s->_cnf._start[m]; j < end; j++)
+	{
+		d->_lit_clause[j] = m;
+		d->_lit_situation[j] = SET;
+		inc_push_occ(s, d->_literals[j], j);
+	}
+}
+
+// Undo the assignment of a solve, so that no symbol is assigned and all
+// the clauses and their literals are SET
+void inc_reset(inc_solver *s)
+{
+	dpll_search *d = &s->_search;
+
+	memset(d->_lit_val, 0, 2 * d->_n * sizeof(unsigned char));
+	memset(d->_clause_situation, SET, d->_m * sizeof(unsigned char));
+	memset(d->_lit_situation, SET, s->_cnf._start[d->_m] * sizeof(unsigned char));
+	memset(d->_core, 0, d->_n * sizeof(unsigned char));
+	d->_stopped = 0;
+	d->_decisions = d->_unit_props = d->_pure_props = d->_backtracks = 0;
+}
+
+void inc_create(inc_solver *s)
+{
+	memset(s, 0, sizeof(inc_solver));
+
+	// _start always has the end of the last clause after the clauses
+	s->_start_cap = 4;
+	s->_cnf._start = (int *) malloc(s->_start_cap * sizeof(int));
+	s->_cnf._start[0] = 0;
+	s->_cnf._card_start = (int *) calloc(1, sizeof(int));
+
+	// The search of no clauses, which grows with them
+	dpll_build(&s->_search, &s->_cnf);
+	s->_search._reason = (int *) malloc(sizeof(int));
+	s->_search._core = (unsigned char *) malloc(sizeof(unsigned char));
+	s->_search._stack = (int *) malloc(sizeof(int));
+}
+
+// Add the clause lits (of len literals, from -N to N, excluding 0).
+// Repeated literals are removed and a clause with both a literal and its
+// opposite is not added. Returns -1 if a literal is 0.
+int inc_add_clause(inc_solver *s, int *lits, int len)
+{
+	int *codes = (int *) malloc((len + 1) * sizeof(int));
+	int num = 0;
+
+	for(int i = 0; i < len; i++)
+	{
+		int code, skip = 0;
+
+		if(lits[i] == 0)
+		{
+			free(codes);
+			return -1;
+		}
+
+		inc_grow(s, abs(lits[i]));
+		code = _lit_code(lits[i]);
+
+		for(int j = 0; j < num && !skip; j++)
+		{
+			if(codes[j] == _lit_neg(code))
+			{
+				free(codes);
+				return 0;
+			}
+
+			skip = (codes[j] == code);
+		}
+
+		if(!skip)
+			codes[num++] = code;
+	}
+
+	// The empty clause can never be true
+	if(num == 0)
+		s->_unsat = 1;
+
+	else
+		inc_push_clause(s, codes, num);
+
+	free(codes);
+	return 0;
+}
+
+// Solve the clauses added so far, with the num literals of assumptions
+// (from -N to N, excluding 0) true. Returns DPLL_STOPPED when the search
+// was interrupted or an assumption is 0.
+enum dpll_result inc_solve(inc_solver *s, int *assumptions, int num)
+{
+	dpll_search *d = &s->_search;
+	enum dpll_result result;
+	int *learned;
+	int i;
+
+	s->_failed_num = 0;
+	s->_has_model = 0;
+	s->_decisions = s->_backtracks = 0;
+	s->_reused = 0;
+
+	if(s->_unsat)
+		return DPLL_UNSAT;
+
+	for(i = 0; i < num; i++)
+	{
+		if(assumptions[i] == 0)
+			return DPLL_STOPPED;
+
+		inc_grow(s, abs(assumptions[i]));
+	}
+
+	// The last model, if it is still one
+	for(i = 0; i < num && (s->_model[abs(assumptions[i]) - 1] == 1) == (assumptions[i] > 0); i++);
+
+	if(i == num && verify_model(&s->_cnf, s->_model))
+	{
+		s->_reused = 1;
+		s->_has_model = 1;
+		return DPLL_SAT;
+	}
+
+	// The assumptions are decisions that are never undone
+	for(i = 0; i < num; i++)
+	{
+		int lit = _lit_code(assumptions[i]);
+
+		if(d->_lit_val[lit])
+			continue;
+
+		// (an assumption that is the opposite of an earlier one)
+		if(d->_lit_val[_lit_neg(lit)])
+		{
+			push_int(&s->_failed, &s->_failed_num, &s->_failed_cap, -assumptions[i]);
+			push_int(&s->_failed, &s->_failed_num, &s->_failed_cap, assumptions[i]);
+			inc_reset(s);
+
+			return DPLL_UNSAT;
+		}
+
+		_assign(d, lit);
+		unset(d, lit);
+		d->_reason[_lit_var(lit)] = -1;
+	}
+
+	if(dpll(d))
+	{
+		store_sol(d, 0);
+
+		for(i = 0; i < s->_cnf._n; i++)
+		{
+			s->_model[i] = d->_sol[i];
+			d->_phase[i] = (d->_sol[i] == 1);
+		}
+
+		s->_has_model = 1;
+		result = DPLL_SAT;
+	}
+
+	else
+		result = ((d->_stopped) ? (DPLL_STOPPED) : (DPLL_UNSAT));
+
+	// The failure depends on the assumptions marked in _core
+	learned = (int *) malloc((num + 1) * sizeof(int));
+
+	for(i = 0; i < num && result == DPLL_UNSAT; i++)
+		if(d->_core[abs(assumptions[i]) - 1] == 1)
+		{
+			d->_core[abs(assumptions[i]) - 1] = 0;
+			learned[s->_failed_num] = _lit_neg(_lit_code(assumptions[i]));
+			push_int(&s->_failed, &s->_failed_num, &s->_failed_cap, assumptions[i]);
+		}
+
+	s->_decisions = d->_decisions;
+	s->_backtracks = d->_backtracks;
+	inc_reset(s);
+
+	if(result == DPLL_UNSAT && s->_failed_num == 0)
+		s->_unsat = 1;
+
+	else if(result == DPLL_UNSAT)
+	{
+		inc_push_clause(s, learned, s->_failed_num);
+		s->_learned++;
+	}
+
+	free(learned);
+
+	return result;
+}
+
+// The truth value (1 or -1) of the literal lit (from -N to N) in the model
+// of the last solve, or 0 if the last solve was not satisfiable
+int inc_value(inc_solver *s, int lit)
+{
+	if(!s->_has_model || lit == 0 || abs(lit) > s->_cnf._n)
+		return 0;
+
+	return ((lit > 0) ? (s->_model[lit - 1]) : (-s->_model[-lit - 1]));
+}
+
+// If the assumption lit is one of the failed assumptions of the last solve
+int inc_failed(inc_solver *s, int lit)
+{
+	for(int i = 0; i < s->_failed_num; i++)
+		if(s->_failed[i] == lit)
+			return 1;
+
+	return 0;
+}
+
+void inc_destroy(inc_solver *s)
+{
+	dpll_free(&s->_search);
+	free_cnf(&s->_cnf);
+	free(s->_occ_cap); free(s->_model); free(s->_failed);
+}
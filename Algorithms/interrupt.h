@@ -0,0 +1,51 @@
+/*
+	Header file for stopping the algorithms gracefully, when the process
+	receives a SIGINT (Ctrl-C) or a SIGTERM (e.g. from a job scheduler).
+
+	The signal handler only records the signal in the interrupted flag.
+	The algorithms check the flag in their main loops, stop the search
+	and write the best (WalkSAT) or partial (DPLL) assignment they have,
+	along with their statistics, before the process exits. They stop the
+	same way when their time limit (measured with wall_time) is reached.
+
+	Kefsenidis Paraskevas, 2023
+*/
+
+#ifndef INTERRUPT_H
+#define INTERRUPT_H
+
+#include <signal.h>
+#include <string.h>
+#include <time.h>
+
+volatile sig_atomic_t interrupted = 0;		// The signal received, 0 if none
+
+void interrupt_handler(int sig)
+{
+	interrupted = sig;
+}
+
+// Wall clock time in seconds, used for the time limits of the searches
+double wall_time(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Install the handler for SIGINT and SIGTERM
+void catch_interrupts(void)
+{
+	struct sigaction sa;
+
+	memset(&sa, 0, sizeof(sa));
+	sa.sa_handler = interrupt_handler;
+	sigemptyset(&sa.sa_mask);
+
+	sigaction(SIGINT, &sa, NULL);
+	sigaction(SIGTERM, &sa, NULL);
+}
+
+#endif
@@ -0,0 +1,35 @@
+/*
+	Header file with the encoding of the literals, shared by the algorithms.
+
+	In the input and output files, the literal Pi is written as i and !Pi
+	as -i. Internally, each literal is encoded as a code: 2 * (i - 1) for Pi
+	and 2 * (i - 1) + 1 for !Pi, so the symbol of a literal is code >> 1,
+	its sign is code & 1 and the opposite literal is code ^ 1.
+
+	The truth values of an assignment are kept in a byte array indexed by
+	the code of the literal (2 * N bytes), so the truth value of a literal
+	is a single load, with no sign test: lit_val[code] is 1 if the literal
+	is true.
+
+	Kefsenidis Paraskevas, 2023
+*/
+
+#ifndef LITERAL_H
+#define LITERAL_H
+
+#include <stdlib.h>
+
+// The code of a literal, as it is written in the input file (-N to N, excluding 0)
+#define _lit_code(lit_opt) ((abs(lit_opt) - 1) * 2 + ((lit_opt) < 0))
+
+// The literal of the input file (-N to N), from its code
+#define _lit_number(code) (((code) & 1) ? (-((code) >> 1) - 1) : (((code) >> 1) + 1))
+
+#define _lit_var(code) ((code) >> 1)		// The symbol of a literal (0 for P1)
+#define _lit_neg(code) ((code) ^ 1)			// The opposite literal
+#define _lit_sign(code) ((code) & 1)		// 1 for negative literals
+
+// The literal of a symbol that is true, when the symbol has the truth value val
+#define _true_lit(var, val) ((var) * 2 + !(val))
+
+#endif
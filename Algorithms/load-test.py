@@ -0,0 +1,99 @@
+#!/usr/bin/env python3
+"""
+    Load test of the server mode of bcsp-mod.c (see server.h).
+
+    Each of the --concurrency clients opens one connection and sends its
+    share of the --requests requests on it, one after the other, cycling
+    through the input files. The latency of each request is measured from
+    the request being sent to the "end" line of its response. At the end
+    the requests per second and the latency percentiles are printed.
+
+    Syntax:
+    load-test.py <socket> <method> <inputfile> [<inputfile> ...]
+                 [--requests <number>] [--concurrency <number>]
+                 [--options "<request options>"]
+
+    Kefsenidis Paraskevas, 2023
+"""
+
+import argparse
+import socket
+import threading
+import time
+
+
+def client(path, requests, results):
+    sock = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+    sock.connect(path)
+    reader = sock.makefile("rb")
+
+    for request in requests:
+        start = time.perf_counter()
+        sock.sendall(request)
+        result = None
+
+        for line in reader:
+            if line.startswith(b"result "):
+                result = line.split()[1].decode()
+            elif line == b"end\n":
+                break
+
+        results.append((time.perf_counter() - start, result))
+
+    sock.close()
+
+
+def percentile(values, p):
+    return values[min(len(values) - 1, int(p / 100 * len(values)))]
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Load test of the bcsp-mod server")
+    parser.add_argument("socket")
+    parser.add_argument("method")
+    parser.add_argument("files", nargs="+")
+    parser.add_argument("--requests", type=int, default=1000)
+    parser.add_argument("--concurrency", type=int, default=4)
+    parser.add_argument("--options", default="")
+    args = parser.parse_args()
+
+    problems = []
+
+    for name in args.files:
+        with open(name, "rb") as f:
+            problems.append(("%s %s\n" % (args.method, args.options)).encode() + f.read() + b"\n")
+
+    threads = []
+    results = []
+
+    for c in range(args.concurrency):
+        share = range(c, args.requests, args.concurrency)
+        requests = [problems[i % len(problems)] for i in share]
+        threads.append(threading.Thread(target=client, args=(args.socket, requests, results)))
+
+    start = time.perf_counter()
+
+    for t in threads:
+        t.start()
+
+    for t in threads:
+        t.join()
+
+    elapsed = time.perf_counter() - start
+    latencies = sorted(r[0] * 1000 for r in results)
+    counts = {}
+
+    for r in results:
+        counts[r[1]] = counts.get(r[1], 0) + 1
+
+    print("Requests: %d in %f secs (%d clients)" % (len(results), elapsed, args.concurrency))
+    print("Results: %s" % ", ".join("%s %d" % (k, v) for k, v in sorted(counts.items(), key=str)))
+    print("Requests per second: %.1f" % (len(results) / elapsed))
+
+    if latencies:
+        print("Latency (ms): p50 %.3f, p90 %.3f, p99 %.3f, max %.3f" % (
+            percentile(latencies, 50), percentile(latencies, 90), percentile(latencies, 99), latencies[-1]))
+
+
+if __name__ == "__main__":
+    main()
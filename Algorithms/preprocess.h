@@ -0,0 +1,1276 @@
+/*
+	Header file containing the preprocessing of the problem, that runs
+	before the algorithms, in order to make the problem smaller:
+
+	- Clauses with the same literal twice are shortened, clauses with both
+	  a literal and its opposite (always true) are removed, as well as
+	  clauses that appear more than once (duplicates).
+	- Unit propagation: the literal of a clause with a single literal is
+	  fixed to true, so the clauses containing it are removed and its
+	  opposite literal is removed from the rest.
+	- Subsumption: a clause C that contains all the literals of a clause D
+	  is removed, as it is true whenever D is true.
+	- Self-subsuming resolution: if C contains !l and all the literals of D
+	  except l, which D contains, the literal !l is removed from C.
+	- Failed literal probing: each literal is set to true and unit
+	  propagation runs on the clauses. If that leads to a false clause, the
+	  literal is failed and its opposite is fixed. Literals that are true
+	  after the propagation of both the literal and its opposite are fixed.
+	- Equivalent literal substitution: the clauses with two literals (a, b)
+	  are the implications !a -> b and !b -> a. The literals of a strongly
+	  connected component of these implications are all equivalent, so they
+	  are replaced by one of them (the one with the smallest code) in all the
+	  clauses. A component with a literal and its opposite is unsatisfiable.
+	- Bounded variable elimination (as in SatELite): the clauses containing
+	  a symbol are replaced by all their resolvents on that symbol, when the
+	  resolvents (that are not always true) are not more than the clauses
+	  they replace. Pure symbols are eliminated the same way, as they have
+	  no resolvents.
+
+	Clauses are found through occurrence lists of the literals, and a 64
+	bit signature of the symbols of each clause quickly rules out most
+	candidates for subsumption.
+
+	The eliminated symbols and the fixed ones do not appear in the reduced
+	problem, so the algorithms assign them a random or arbitrary value.
+	The removed clauses that contain them are pushed to a stack, with the
+	literal of the symbol first, and extend_model goes over the stack in
+	reverse, setting that literal to true in every clause that the model
+	does not satisfy, which gives a model of the original problem. A symbol
+	replaced by an equivalent literal r is pushed as the two clauses of the
+	equivalence (P, !r) and (!P, r), so that it gets the truth value of r.
+
+	The symbols keep their numbers, so the algorithms solve a problem with
+	the same N, fewer clauses and clauses of different lengths.
+
+	The cardinality constraints (see cnf.h) are not used by the steps
+	above, which stay sound on the clauses alone, but the symbols of the
+	constraints are frozen: they are neither eliminated nor substituted, as
+	the constraints would have to change with them. The fixed literals are
+	removed from the constraints of the reduced problem, a true one
+	lowering the bound, and constraints that every assignment satisfies
+	are left out.
+
+	When a proof of unsatisfiability is written (see proof.h), every clause
+	the preprocessing makes is added to the proof before the clauses it
+	comes from are deleted. All of them are implied by unit propagation:
+	the strengthened clauses, the units, the resolvents and the clauses with
+	substituted literals (through the implications of the two literal
+	clauses, which are deleted only after all the clauses are substituted).
+	A literal that both literals of a symbol imply is added after the two
+	clauses (!P, l) and (P, l). The proof of the failed literals needs
+	nothing more, and neither do the clauses that are only removed, as
+	deleting clauses never makes a wrong proof.
+
+	Links used:
+	http://minisat.se/downloads/SatELite.pdf
+	https://fmv.jku.at/papers/HeuleJarvisaloBiere-CPAIOR11.pdf
+	https://fmv.jku.at/papers/JarvisaloBiereHeule-TACAS10.pdf
+
+	Kefsenidis Paraskevas, 2023
+*/
+
+#ifndef PREPROCESS_H
+#define PREPROCESS_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "cnf.h"
+#include "interrupt.h"
+#include "literal.h"
+#include "proof.h"
+
+#define PRE_OCC_LIMIT		16		// Symbols with more occurrences of both literals are not eliminated
+#define PRE_RESOLVENT_LIMIT	16		// Eliminations that need longer resolvents are skipped
+#define PRE_PROBE_LIMIT		50000000	// Clause visits of the probing, before it gives up
+
+// The signature of a clause has a bit for each of its symbols (modulo 64)
+#define _pre_sig_bit(lit) (1ULL << (_lit_var(lit) & 63))
+
+// State of the preprocessing
+typedef struct preprocessor
+{
+	int _n;
+
+	// The clauses. Removed clauses keep their number, with _deleted set
+	int **_cls;
+	int *_size;
+	char *_deleted;
+	uint64_t *_sig;
+	char *_queued;			// If the clause waits in _queue, to be used for subsumption
+	int _num;
+	int _cap;
+
+	// Occurrence lists (clause numbers) of each literal. Removed
+	// clauses are only removed from the lists when they are cleaned.
+	int **_occ;
+	int *_occ_num;
+	int *_occ_cap;
+
+	unsigned char *_val;	// The fixed literals are 1 (2 * N, indexed by code)
+	char *_eliminated;		// The eliminated symbols (N)
+	char *_frozen;			// The symbols of the cardinality constraints (N)
+	int *_mark;				// Marks of literals (2 * N), when _mark[lit] == _stamp
+	int _stamp;
+
+	// Probing: the literals made true by the propagation of a probe
+	// have _probe[lit] == _stamp and they are also kept in _trail
+	int *_probe;
+	int *_trail;
+	int _trail_num;
+	long _probe_steps;
+
+	int *_queue;			// Clauses to be used for subsumption
+	int _queue_num;
+	int _queue_cap;
+	int *_units;			// Fixed literals, that have not been propagated yet
+	int _units_num;
+	int _units_cap;
+
+	// The stack of the removed clauses, for the model reconstruction.
+	// Each clause is pushed with the literal of its symbol first and
+	// then its length.
+	int *_stack;
+	int _stack_num;
+	int _stack_cap;
+
+	int _unsat;				// Set when an empty clause is found
+	proof_lines _proof;		// The lines of the proof of unsatisfiability (see proof.h)
+
+	// Statistics
+	long _duplicates;
+	long _fixed;
+	long _subsumed;
+	long _strengthened;
+	long _eliminated_num;
+	long _failed;
+	long _implied;
+	long _substituted;
+} preprocessor;
+
+// The answer found for a problem
+enum problem_answer {ANSWER_UNKNOWN, ANSWER_SAT, ANSWER_UNSAT};
+
+// A problem, as it was read and as the algorithms solve it
+typedef struct problem
+{
+	int _preprocessing;		// If the preprocessing runs before the algorithms (set before load_problem)
+	int _number;			// The number of the problem in a stream of problems (0 for the first or only one)
+	proof *_proof;			// The proof of unsatisfiability being written (NULL if none)
+	preprocessor _pre;		// The preprocessing of the problem
+	cnf _input;				// The problem as it was read, used to verify the models
+	cnf _cnf;				// The problem the algorithms solve
+
+	// The answer, as it is kept in the result cache (see cache.h): a
+	// verified model sets ANSWER_SAT (with a copy of it in _model, see
+	// finish_model), and the methods set ANSWER_UNSAT when there is no
+	// solution. Both are set to zero before the problem is solved.
+	enum problem_answer _answer;
+	int *_model;
+} problem;
+
+// Add x at the end of a growing array
+void push_int(int **arr, int *num, int *cap, int x)
+{
+	if(*num == *cap)
+	{
+		*cap = ((*cap) ? (*cap * 2) : (4));
+		*arr = (int *) realloc(*arr, *cap * sizeof(int));
+	}
+
+	(*arr)[(*num)++] = x;
+}
+
+int compare_int(const void *a, const void *b)
+{
+	return *(const int *) a - *(const int *) b;
+}
+
+// Fix the literal lit to true. The unit clause of lit must
+// already be in the proof.
+void pre_fix(preprocessor *p, int lit)
+{
+	if(p->_val[lit])
+		return;
+
+	if(p->_val[_lit_neg(lit)])
+	{
+		proof_clause(&p->_proof, 'a', NULL, 0);
+		p->_unsat = 1;
+		return;
+	}
+
+	p->_val[lit] = 1;
+	p->_fixed++;
+
+	push_int(&p->_units, &p->_units_num, &p->_units_cap, lit);
+
+	// The fixed literal is a clause of the stack by itself
+	push_int(&p->_stack, &p->_stack_num, &p->_stack_cap, lit);
+	push_int(&p->_stack, &p->_stack_num, &p->_stack_cap, 1);
+}
+
+// Add a clause to the subsumption queue
+void pre_enqueue(preprocessor *p, int c)
+{
+	if(!p->_queued[c])
+	{
+		p->_queued[c] = 1;
+		push_int(&p->_queue, &p->_queue_num, &p->_queue_cap, c);
+	}
+}
+
+void pre_compute_sig(preprocessor *p, int c)
+{
+	p->_sig[c] = 0;
+
+	for(int i = 0; i < p->_size[c]; i++)
+		p->_sig[c] |= _pre_sig_bit(p->_cls[c][i]);
+}
+
+// Add a clause (len literals). The literals are sorted, repeated
+// ones are removed and so are clauses that are always true or
+// satisfied by the fixed literals. Units are fixed instead. A derived
+// clause (not one of the problem) is added to the proof, as is a clause
+// of the problem that lost literals.
+void pre_add_clause(preprocessor *p, int *lits, int len, int derived)
+{
+	int *cls = (int *) malloc((len + 1) * sizeof(int));
+	int size = 0;
+	int c;
+
+	memcpy(cls, lits, len * sizeof(int));
+	qsort(cls, len, sizeof(int), compare_int);
+
+	for(int i = 0; i < len; i++)
+	{
+		// Always true, or true because of a fixed literal
+		if((size > 0 && cls[size - 1] == _lit_neg(cls[i])) || p->_val[cls[i]])
+		{
+			free(cls);
+			return;
+		}
+
+		// Repeated literal, or a literal fixed to false
+		if((size > 0 && cls[size - 1] == cls[i]) || p->_val[_lit_neg(cls[i])])
+			continue;
+
+		cls[size++] = cls[i];
+	}
+
+	if(derived || size < len)
+		proof_clause(&p->_proof, 'a', cls, size);
+
+	if(size <= 1)
+	{
+		if(size == 0)
+			p->_unsat = 1;
+		else
+			pre_fix(p, cls[0]);
+
+		free(cls);
+		return;
+	}
+
+	if(p->_num == p->_cap)
+	{
+		p->_cap = ((p->_cap) ? (p->_cap * 2) : (64));
+		p->_cls = (int **) realloc(p->_cls, p->_cap * sizeof(int *));
+		p->_size = (int *) realloc(p->_size, p->_cap * sizeof(int));
+		p->_deleted = (char *) realloc(p->_deleted, p->_cap * sizeof(char));
+		p->_sig = (uint64_t *) realloc(p->_sig, p->_cap * sizeof(uint64_t));
+		p->_queued = (char *) realloc(p->_queued, p->_cap * sizeof(char));
+	}
+
+	c = p->_num++;
+	p->_cls[c] = cls;
+	p->_size[c] = size;
+	p->_deleted[c] = 0;
+	p->_queued[c] = 0;
+	pre_compute_sig(p, c);
+
+	for(int i = 0; i < size; i++)
+		push_int(&p->_occ[cls[i]], &p->_occ_num[cls[i]], &p->_occ_cap[cls[i]], c);
+
+	pre_enqueue(p, c);
+}
+
+// Remove clause c. Removed clauses may still be in occurrence lists, and
+// they must not be deleted from the proof again.
+void pre_delete(preprocessor *p, int c)
+{
+	if(p->_deleted[c])
+		return;
+
+	proof_clause(&p->_proof, 'd', p->_cls[c], p->_size[c]);
+	p->_deleted[c] = 1;
+}
+
+// Remove the removed clauses from the occurrence list of a literal
+void pre_clean_occ(preprocessor *p, int lit)
+{
+	int num = 0;
+
+	for(int i = 0; i < p->_occ_num[lit]; i++)
+		if(!p->_deleted[p->_occ[lit][i]])
+			p->_occ[lit][num++] = p->_occ[lit][i];
+
+	p->_occ_num[lit] = num;
+}
+
+// Remove the literal lit from clause c
+void pre_strengthen(preprocessor *p, int c, int lit)
+{
+	int size = 0;
+
+	// The clause without lit, then the clause with it
+	if(p->_proof._proof != NULL)
+	{
+		proof_begin(&p->_proof, 'a', p->_size[c] - 1);
+
+		for(int i = 0; i < p->_size[c]; i++)
+			if(p->_cls[c][i] != lit)
+				proof_lit(&p->_proof, p->_cls[c][i]);
+
+		proof_end(&p->_proof);
+		proof_clause(&p->_proof, 'd', p->_cls[c], p->_size[c]);
+	}
+
+	for(int i = 0; i < p->_size[c]; i++)
+		if(p->_cls[c][i] != lit)
+			p->_cls[c][size++] = p->_cls[c][i];
+
+	p->_size[c] = size;
+	pre_compute_sig(p, c);
+
+	// Remove c from the occurrence list of lit
+	for(int i = 0; i < p->_occ_num[lit]; i++)
+		if(p->_occ[lit][i] == c)
+		{
+			p->_occ[lit][i] = p->_occ[lit][--p->_occ_num[lit]];
+			break;
+		}
+
+	// The unit stays in the proof, as the clause of the fixed literal
+	if(size == 1)
+	{
+		pre_fix(p, p->_cls[c][0]);
+		p->_deleted[c] = 1;
+	}
+
+	else
+		pre_enqueue(p, c);
+}
+
+// Propagate the fixed literals, that have not been propagated yet
+void pre_propagate(preprocessor *p)
+{
+	while(p->_units_num > 0 && !p->_unsat)
+	{
+		int lit = p->_units[--p->_units_num];
+		int neg = _lit_neg(lit);
+
+		// The clauses containing lit are true
+		for(int i = 0; i < p->_occ_num[lit]; i++)
+			pre_delete(p, p->_occ[lit][i]);
+
+		p->_occ_num[lit] = 0;
+
+		// and !lit is removed from the rest. The list is emptied first,
+		// as it is the one that pre_strengthen removes the clauses from.
+		int num = p->_occ_num[neg];
+		int *occ = (int *) malloc((num + 1) * sizeof(int));
+
+		memcpy(occ, p->_occ[neg], num * sizeof(int));
+		p->_occ_num[neg] = 0;
+
+		for(int i = 0; i < num && !p->_unsat; i++)
+			if(!p->_deleted[occ[i]])
+				pre_strengthen(p, occ[i], neg);
+
+		free(occ);
+	}
+}
+
+// Mark the literals of a clause
+void pre_mark(preprocessor *p, int c)
+{
+	p->_stamp++;
+
+	for(int i = 0; i < p->_size[c]; i++)
+		p->_mark[p->_cls[c][i]] = p->_stamp;
+}
+
+// Number of the literals of clause d, that are marked
+int pre_marked_num(preprocessor *p, int d)
+{
+	int num = 0;
+
+	for(int i = 0; i < p->_size[d]; i++)
+		num += (p->_mark[p->_cls[d][i]] == p->_stamp);
+
+	return num;
+}
+
+// Use clause c to remove the clauses it subsumes and to
+// strengthen the clauses it self-subsumes
+void pre_subsume(preprocessor *p, int c)
+{
+	int best;
+	int size = p->_size[c];
+
+	pre_mark(p, c);
+
+	// Subsumed clauses contain all the literals of c, so it is enough
+	// to search the shortest occurrence list of them
+	best = p->_cls[c][0];
+
+	for(int i = 1; i < size; i++)
+		if(p->_occ_num[p->_cls[c][i]] < p->_occ_num[best])
+			best = p->_cls[c][i];
+
+	for(int i = 0; i < p->_occ_num[best]; i++)
+	{
+		int d = p->_occ[best][i];
+
+		if(d == c || p->_deleted[d] || p->_size[d] < size || (p->_sig[c] & ~p->_sig[d]))
+			continue;
+
+		if(pre_marked_num(p, d) == size)
+		{
+			pre_delete(p, d);
+			p->_subsumed++;
+		}
+	}
+
+	// A clause d containing !lit and the rest of the literals of c
+	// loses !lit. The symbols of d are the same, so the signature
+	// test does not change.
+	for(int j = 0; j < size && !p->_unsat; j++)
+	{
+		int neg = _lit_neg(p->_cls[c][j]);
+
+		for(int i = 0; i < p->_occ_num[neg] && !p->_unsat; i++)
+		{
+			int d = p->_occ[neg][i];
+
+			if(p->_deleted[d] || p->_size[d] < size || (p->_sig[c] & ~p->_sig[d]))
+				continue;
+
+			if(pre_marked_num(p, d) == size - 1)
+			{
+				pre_strengthen(p, d, neg);
+				p->_strengthened++;
+				i--;		// d was removed from the list of neg
+			}
+		}
+	}
+}
+
+// Use the clauses of the queue for subsumption, until it is empty
+void pre_subsume_queue(preprocessor *p)
+{
+	while(p->_queue_num > 0 && !p->_unsat && !interrupted)
+	{
+		int c = p->_queue[--p->_queue_num];
+
+		p->_queued[c] = 0;
+
+		if(!p->_deleted[c])
+			pre_subsume(p, c);
+
+		pre_propagate(p);
+	}
+}
+
+// Resolve clauses a (containing the literal of var) and b (containing its
+// opposite) into res. Returns the length of the resolvent, or -1 if it is
+// always true.
+int pre_resolve(preprocessor *p, int a, int b, int var, int *res)
+{
+	int len = 0;
+
+	p->_stamp++;
+
+	for(int i = 0; i < p->_size[a]; i++)
+		if(_lit_var(p->_cls[a][i]) != var)
+		{
+			p->_mark[p->_cls[a][i]] = p->_stamp;
+			res[len++] = p->_cls[a][i];
+		}
+
+	for(int i = 0; i < p->_size[b]; i++)
+	{
+		int lit = p->_cls[b][i];
+
+		if(_lit_var(lit) == var || p->_mark[lit] == p->_stamp)
+			continue;
+
+		if(p->_mark[_lit_neg(lit)] == p->_stamp)
+			return -1;
+
+		res[len++] = lit;
+	}
+
+	return len;
+}
+
+// Push clause c to the stack, with the literal of var first
+void pre_push_clause(preprocessor *p, int c, int var)
+{
+	int first = -1;
+
+	for(int i = 0; i < p->_size[c]; i++)
+		if(_lit_var(p->_cls[c][i]) == var)
+			first = p->_cls[c][i];
+
+	push_int(&p->_stack, &p->_stack_num, &p->_stack_cap, first);
+
+	for(int i = 0; i < p->_size[c]; i++)
+		if(p->_cls[c][i] != first)
+			push_int(&p->_stack, &p->_stack_num, &p->_stack_cap, p->_cls[c][i]);
+
+	push_int(&p->_stack, &p->_stack_num, &p->_stack_cap, p->_size[c]);
+}
+
+// Try to eliminate a symbol. Returns 1 if it was eliminated.
+int pre_eliminate(preprocessor *p, int var)
+{
+	int pos = var * 2;
+	int neg = pos + 1;
+	int np, nn;
+	int *res;					// The resolvents, each followed by its length
+	int res_num = 0, res_cap = 0;
+	int *tmp;
+	int resolvents = 0;
+
+	if(p->_eliminated[var] || p->_frozen[var] || p->_val[pos] || p->_val[neg])
+		return 0;
+
+	pre_clean_occ(p, pos);
+	pre_clean_occ(p, neg);
+	np = p->_occ_num[pos];
+	nn = p->_occ_num[neg];
+
+	// Symbols that are not in any clause are left to the algorithms
+	if(np + nn == 0 || (np > PRE_OCC_LIMIT && nn > PRE_OCC_LIMIT))
+		return 0;
+
+	res = NULL;
+	tmp = (int *) malloc((2 * p->_n + 1) * sizeof(int));
+
+	for(int i = 0; i < np; i++)
+		for(int j = 0; j < nn; j++)
+		{
+			int len = pre_resolve(p, p->_occ[pos][i], p->_occ[neg][j], var, tmp);
+
+			if(len < 0)
+				continue;
+
+			// Bounded: not more clauses than the ones removed, nor too long ones
+			if(++resolvents > np + nn || len > PRE_RESOLVENT_LIMIT)
+			{
+				free(res); free(tmp);
+				return 0;
+			}
+
+			for(int l = 0; l < len; l++)
+				push_int(&res, &res_num, &res_cap, tmp[l]);
+
+			push_int(&res, &res_num, &res_cap, len);
+		}
+
+	free(tmp);
+
+	// Replace the clauses with the resolvents
+	for(int i = 0; i < np; i++)
+		pre_push_clause(p, p->_occ[pos][i], var);
+
+	for(int i = 0; i < nn; i++)
+		pre_push_clause(p, p->_occ[neg][i], var);
+
+	p->_eliminated[var] = 1;
+	p->_eliminated_num++;
+
+	// The resolvents were stored with their length after them,
+	// so they are added from the last one
+	for(int end = res_num; end > 0 && !p->_unsat; )
+	{
+		int len = res[end - 1];
+
+		pre_add_clause(p, res + end - 1 - len, len, 1);
+		end -= len + 1;
+	}
+
+	// The clauses are deleted after the resolvents were added, for the proof
+	for(int i = 0; i < np; i++)
+		pre_delete(p, p->_occ[pos][i]);
+
+	for(int i = 0; i < nn; i++)
+		pre_delete(p, p->_occ[neg][i]);
+
+	p->_occ_num[pos] = 0;
+	p->_occ_num[neg] = 0;
+
+	free(res);
+
+	return 1;
+}
+
+// Set lit to true in the current probe
+void pre_probe_set(preprocessor *p, int lit)
+{
+	p->_probe[lit] = p->_stamp;
+	p->_trail[p->_trail_num++] = lit;
+}
+
+// Set lit to true and run unit propagation on the clauses, without
+// changing them. Returns 0 if a clause becomes false.
+int pre_probe(preprocessor *p, int lit)
+{
+	p->_stamp++;
+	p->_trail_num = 0;
+	pre_probe_set(p, lit);
+
+	for(int t = 0; t < p->_trail_num; t++)
+	{
+		int neg = _lit_neg(p->_trail[t]);
+
+		// Only the clauses containing the opposite of a true literal can become unit
+		for(int i = 0; i < p->_occ_num[neg]; i++)
+		{
+			int c = p->_occ[neg][i];
+			int free_num = 0;		// The literals of the clause that are not false
+			int last = -1;
+
+			if(p->_deleted[c])
+				continue;
+
+			p->_probe_steps++;
+
+			for(int j = 0; j < p->_size[c]; j++)
+			{
+				int x = p->_cls[c][j];
+
+				if(p->_val[x] || p->_probe[x] == p->_stamp)
+				{
+					free_num = -1;		// The clause is true
+					break;
+				}
+
+				if(!p->_val[_lit_neg(x)] && p->_probe[_lit_neg(x)] != p->_stamp)
+				{
+					free_num++;
+					last = x;
+				}
+			}
+
+			if(free_num == 0)
+				return 0;
+
+			if(free_num == 1)
+				pre_probe_set(p, last);
+		}
+	}
+
+	return 1;
+}
+
+// Add the literal lit, that both pos and its opposite imply, to the proof.
+// Each of the two clauses (!pos, lit) and (pos, lit) is implied by the
+// propagation of a probe, and together they imply lit.
+void pre_proof_implied(preprocessor *p, int pos, int lit)
+{
+	int cls[2][2] = {{_lit_neg(pos), lit}, {pos, lit}};
+
+	proof_clause(&p->_proof, 'a', cls[0], 2);
+	proof_clause(&p->_proof, 'a', cls[1], 2);
+	proof_clause(&p->_proof, 'a', &lit, 1);
+	proof_clause(&p->_proof, 'd', cls[0], 2);
+	proof_clause(&p->_proof, 'd', cls[1], 2);
+}
+
+// Probe both literals of every symbol, fixing the failed
+// literals and the literals that both of them imply
+void pre_probe_all(preprocessor *p)
+{
+	int *implied = (int *) malloc(2 * p->_n * sizeof(int));
+
+	for(int var = 0; var < p->_n && !p->_unsat && !interrupted && p->_probe_steps < PRE_PROBE_LIMIT; var++)
+	{
+		int pos = var * 2;
+		int neg = pos + 1;
+		int implied_num;
+
+		if(p->_eliminated[var] || p->_val[pos] || p->_val[neg] || p->_occ_num[pos] + p->_occ_num[neg] == 0)
+			continue;
+
+		if(!pre_probe(p, pos))
+		{
+			proof_clause(&p->_proof, 'a', &neg, 1);
+			pre_fix(p, neg);
+			pre_propagate(p);
+			p->_failed++;
+			continue;
+		}
+
+		implied_num = p->_trail_num;
+		memcpy(implied, p->_trail, implied_num * sizeof(int));
+
+		if(!pre_probe(p, neg))
+		{
+			proof_clause(&p->_proof, 'a', &pos, 1);
+			pre_fix(p, pos);
+			pre_propagate(p);
+			p->_failed++;
+			continue;
+		}
+
+		for(int i = 0; i < implied_num; i++)
+			if(p->_probe[implied[i]] == p->_stamp && !p->_val[implied[i]])
+			{
+				pre_proof_implied(p, pos, implied[i]);
+				pre_fix(p, implied[i]);
+				p->_implied++;
+			}
+
+		pre_propagate(p);
+	}
+
+	free(implied);
+}
+
+// Find the strongly connected components of the implications of the
+// clauses with two literals (Tarjan's algorithm, without recursion) and
+// set rep[lit] to the literal with the smallest code of its component.
+// Returns 1 if a literal and its opposite are in the same component.
+int pre_components(preprocessor *p, int *rep)
+{
+	int nodes = 2 * p->_n;
+	int *edge_start = (int *) calloc(nodes + 1, sizeof(int));
+	int *edges;
+	int *index = (int *) malloc(nodes * sizeof(int));
+	int *low = (int *) malloc(nodes * sizeof(int));
+	int *next = (int *) malloc(nodes * sizeof(int));		// The next edge to visit, of each node
+	char *on_stack = (char *) calloc(nodes, sizeof(char));
+	int *stack = (int *) malloc(nodes * sizeof(int));
+	int *calls = (int *) malloc(nodes * sizeof(int));		// The nodes of the recursion
+	int stack_num = 0, calls_num = 0, idx = 0;
+	int unsat = 0;
+
+	// Edges !a -> b and !b -> a, stored like the occurrence lists
+	for(int c = 0; c < p->_num; c++)
+		if(!p->_deleted[c] && p->_size[c] == 2)
+		{
+			edge_start[_lit_neg(p->_cls[c][0]) + 1]++;
+			edge_start[_lit_neg(p->_cls[c][1]) + 1]++;
+		}
+
+	for(int i = 0; i < nodes; i++)
+		edge_start[i + 1] += edge_start[i];
+
+	edges = (int *) malloc((edge_start[nodes] + 1) * sizeof(int));
+
+	for(int i = 0; i < nodes; i++)
+		next[i] = edge_start[i];
+
+	for(int c = 0; c < p->_num; c++)
+		if(!p->_deleted[c] && p->_size[c] == 2)
+		{
+			edges[next[_lit_neg(p->_cls[c][0])]++] = p->_cls[c][1];
+			edges[next[_lit_neg(p->_cls[c][1])]++] = p->_cls[c][0];
+		}
+
+	for(int i = 0; i < nodes; i++)
+	{
+		index[i] = -1;
+		next[i] = edge_start[i];
+		rep[i] = i;
+	}
+
+	for(int s = 0; s < nodes; s++)
+	{
+		if(index[s] >= 0)
+			continue;
+
+		calls[calls_num++] = s;
+		index[s] = low[s] = idx++;
+		stack[stack_num++] = s;
+		on_stack[s] = 1;
+
+		while(calls_num > 0)
+		{
+			int v = calls[calls_num - 1];
+
+			if(next[v] < edge_start[v + 1])
+			{
+				int w = edges[next[v]++];
+
+				if(index[w] < 0)
+				{
+					calls[calls_num++] = w;
+					index[w] = low[w] = idx++;
+					stack[stack_num++] = w;
+					on_stack[w] = 1;
+				}
+
+				else if(on_stack[w] && index[w] < low[v])
+					low[v] = index[w];
+
+				continue;
+			}
+
+			// All the edges of v were visited
+			calls_num--;
+
+			if(calls_num > 0 && low[v] < low[calls[calls_num - 1]])
+				low[calls[calls_num - 1]] = low[v];
+
+			if(low[v] == index[v])
+			{
+				int first = stack_num;
+				int min = v;
+
+				do
+				{
+					first--;
+
+					if(stack[first] < min)
+						min = stack[first];
+				}
+				while(stack[first] != v);
+
+				for(int i = first; i < stack_num; i++)
+				{
+					on_stack[stack[i]] = 0;
+					rep[stack[i]] = min;
+				}
+
+				stack_num = first;
+			}
+		}
+	}
+
+	// The component of a literal, with the opposite literals, is the
+	// component of its opposite, so the smallest codes are opposite too.
+	for(int var = 0; var < p->_n; var++)
+		if(rep[var * 2] == rep[var * 2 + 1])
+			unsat = 1;
+
+	free(edge_start); free(edges); free(index); free(low); free(next);
+	free(on_stack); free(stack); free(calls);
+
+	return unsat;
+}
+
+// Replace every literal by the representative of its component
+void pre_substitute(preprocessor *p)
+{
+	int *rep = (int *) malloc(2 * p->_n * sizeof(int));
+	int *tmp = (int *) malloc((2 * p->_n + 1) * sizeof(int));
+	int num = p->_num;
+	char *changed = (char *) calloc(num + 1, sizeof(char));
+
+	if(pre_components(p, rep))
+	{
+		// P implies !P and !P implies P, through the two literal clauses
+		for(int var = 0; var < p->_n; var++)
+			if(rep[var * 2] == rep[var * 2 + 1])
+			{
+				int neg = var * 2 + 1;
+
+				proof_clause(&p->_proof, 'a', &neg, 1);
+				proof_clause(&p->_proof, 'a', NULL, 0);
+				break;
+			}
+
+		p->_unsat = 1;
+		free(rep); free(tmp); free(changed);
+		return;
+	}
+
+	// The frozen symbols keep their literals (and may still be the
+	// representatives of others)
+	for(int var = 0; var < p->_n; var++)
+		if(p->_frozen[var])
+		{
+			rep[var * 2] = var * 2;
+			rep[var * 2 + 1] = var * 2 + 1;
+		}
+
+	for(int var = 0; var < p->_n; var++)
+	{
+		int r = rep[var * 2];
+
+		if(r == var * 2)
+			continue;
+
+		// P is equivalent to r
+		push_int(&p->_stack, &p->_stack_num, &p->_stack_cap, var * 2);
+		push_int(&p->_stack, &p->_stack_num, &p->_stack_cap, _lit_neg(r));
+		push_int(&p->_stack, &p->_stack_num, &p->_stack_cap, 2);
+		push_int(&p->_stack, &p->_stack_num, &p->_stack_cap, var * 2 + 1);
+		push_int(&p->_stack, &p->_stack_num, &p->_stack_cap, r);
+		push_int(&p->_stack, &p->_stack_num, &p->_stack_cap, 2);
+
+		p->_eliminated[var] = 1;
+		p->_substituted++;
+	}
+
+	// Add the clauses again, with the substituted literals. The old ones
+	// are deleted after all of them, as their implications are needed for
+	// the proof of the new ones.
+	for(int c = 0; c < num && !p->_unsat; c++)
+	{
+		if(p->_deleted[c])
+			continue;
+
+		for(int i = 0; i < p->_size[c]; i++)
+		{
+			tmp[i] = rep[p->_cls[c][i]];
+			changed[c] |= (tmp[i] != p->_cls[c][i]);
+		}
+
+		if(changed[c])
+			pre_add_clause(p, tmp, p->_size[c], 1);
+	}
+
+	for(int c = 0; c < num; c++)
+		if(changed[c])
+			pre_delete(p, c);
+
+	for(int lit = 0; lit < 2 * p->_n; lit++)
+		if(p->_eliminated[_lit_var(lit)])
+			p->_occ_num[lit] = 0;
+
+	free(rep); free(tmp); free(changed);
+}
+
+// The preprocessor of the clauses or symbols that qsort compares (one
+// for each thread, so that problems can be preprocessed at the same time)
+_Thread_local preprocessor *sort_pre;
+
+// Compare symbols by their number of occurrences
+int compare_occ(const void *a, const void *b)
+{
+	int u = *(const int *) a, v = *(const int *) b;
+
+	return (sort_pre->_occ_num[u * 2] + sort_pre->_occ_num[u * 2 + 1]) -
+		   (sort_pre->_occ_num[v * 2] + sort_pre->_occ_num[v * 2 + 1]);
+}
+
+// Compare clauses by their length and then by their literals
+
+int compare_clauses(const void *a, const void *b)
+{
+	int c = *(const int *) a, d = *(const int *) b;
+
+	if(sort_pre->_size[c] != sort_pre->_size[d])
+		return sort_pre->_size[c] - sort_pre->_size[d];
+
+	for(int i = 0; i < sort_pre->_size[c]; i++)
+		if(sort_pre->_cls[c][i] != sort_pre->_cls[d][i])
+			return sort_pre->_cls[c][i] - sort_pre->_cls[d][i];
+
+	return 0;
+}
+
+// Remove the duplicate clauses, by sorting them
+void pre_remove_duplicates(preprocessor *p)
+{
+	int *order = (int *) malloc((p->_num + 1) * sizeof(int));
+
+	for(int i = 0; i < p->_num; i++)
+		order[i] = i;
+
+	sort_pre = p;
+	qsort(order, p->_num, sizeof(int), compare_clauses);
+
+	for(int i = 1; i < p->_num; i++)
+		if(compare_clauses(&order[i - 1], &order[i]) == 0 && !p->_deleted[order[i]])
+		{
+			pre_delete(p, order[i]);
+			p->_duplicates++;
+		}
+
+	free(order);
+}
+
+// Preprocess the problem f into the reduced problem out, writing its
+// steps to the proof pf (NULL for none). Returns 1 if the problem was
+// found unsatisfiable.
+int preprocess(preprocessor *p, cnf *f, cnf *out, proof *pf)
+{
+	int changed = 1;
+	int len;
+	int *order = (int *) malloc(f->_n * sizeof(int));
+
+	memset(p, 0, sizeof(preprocessor));
+	proof_lines_init(&p->_proof, pf);
+	p->_n = f->_n;
+	p->_occ = (int **) calloc(2 * f->_n, sizeof(int *));
+	p->_occ_num = (int *) calloc(2 * f->_n, sizeof(int));
+	p->_occ_cap = (int *) calloc(2 * f->_n, sizeof(int));
+	p->_val = (unsigned char *) calloc(2 * f->_n, sizeof(unsigned char));
+	p->_eliminated = (char *) calloc(f->_n, sizeof(char));
+	p->_frozen = (char *) calloc(f->_n, sizeof(char));
+	p->_mark = (int *) calloc(2 * f->_n, sizeof(int));
+	p->_probe = (int *) calloc(2 * f->_n, sizeof(int));
+	p->_trail = (int *) malloc(2 * f->_n * sizeof(int));
+
+	for(int i = 0; i < _card_total(f); i++)
+		p->_frozen[_lit_var(f->_card_lits[i])] = 1;
+
+	for(int i = 0; i < f->_m && !p->_unsat; i++)
+		pre_add_clause(p, f->_lits + f->_start[i], _clause_len(f, i), 0);
+
+	pre_remove_duplicates(p);
+	pre_propagate(p);
+	pre_subsume_queue(p);
+
+	// Probing and substitution, before the elimination, as they
+	// may fix or remove symbols that the elimination would skip
+	if(!p->_unsat && !interrupted)
+		pre_probe_all(p);
+
+	if(!p->_unsat && !interrupted)
+	{
+		pre_substitute(p);
+		pre_propagate(p);
+	}
+
+	// Subsumption, then elimination of the symbols with the fewest
+	// occurrences first, until no symbol can be eliminated
+	while(changed && !p->_unsat && !interrupted)
+	{
+		changed = 0;
+		pre_subsume_queue(p);
+
+		for(int var = 0; var < f->_n; var++)
+		{
+			pre_clean_occ(p, var * 2);
+			pre_clean_occ(p, var * 2 + 1);
+			order[var] = var;
+		}
+
+		sort_pre = p;
+		qsort(order, f->_n, sizeof(int), compare_occ);
+
+		for(int i = 0; i < f->_n && !p->_unsat && !interrupted; i++)
+		{
+			if(pre_eliminate(p, order[i]))
+			{
+				changed = 1;
+				pre_propagate(p);
+				pre_subsume_queue(p);
+			}
+		}
+	}
+
+	// Store the clauses that remain
+	out->_n = f->_n;
+	out->_m = 0;
+	out->_k = 1;
+	len = 0;
+
+	for(int i = 0; i < p->_num; i++)
+		if(!p->_deleted[i])
+		{
+			out->_m++;
+			len += p->_size[i];
+		}
+
+	out->_start = (int *) malloc((out->_m + 1) * sizeof(int));
+	out->_lits = (int *) malloc((len + 1) * sizeof(int));
+	out->_m = 0;
+	len = 0;
+
+	for(int i = 0; i < p->_num; i++)
+		if(!p->_deleted[i])
+		{
+			out->_start[out->_m++] = len;
+			memcpy(out->_lits + len, p->_cls[i], p->_size[i] * sizeof(int));
+			len += p->_size[i];
+
+			if(p->_size[i] > out->_k)
+				out->_k = p->_size[i];
+		}
+
+	out->_start[out->_m] = len;
+
+	// The cardinality constraints, without the fixed literals
+	out->_c = 0;
+	out->_card_start = out->_card_lits = out->_card_bound = NULL;
+
+	if(f->_c > 0)
+	{
+		out->_card_start = (int *) malloc((f->_c + 1) * sizeof(int));
+		out->_card_lits = (int *) malloc(_card_total(f) * sizeof(int));
+		out->_card_bound = (int *) malloc(f->_c * sizeof(int));
+	}
+
+	len = 0;
+
+	for(int i = 0; i < f->_c; i++)
+	{
+		int bound = f->_card_bound[i];
+		int start = len;
+
+		for(int j = f->_card_start[i]; j < f->_card_start[i + 1]; j++)
+		{
+			int lit = f->_card_lits[j];
+
+			if(p->_val[lit])
+				bound--;
+			else if(!p->_val[_lit_neg(lit)])
+				out->_card_lits[len++] = lit;
+		}
+
+		// Too many true literals already
+		if(bound < 0)
+			p->_unsat = 1;
+
+		// Not more unfixed literals than the bound
+		if(bound >= len - start)
+		{
+			len = start;
+			continue;
+		}
+
+		out->_card_start[out->_c] = start;
+		out->_card_bound[out->_c++] = bound;
+	}
+
+	if(out->_c > 0)
+		out->_card_start[out->_c] = len;
+
+	// The clauses themselves are no longer needed, the stack is
+	for(int i = 0; i < p->_num; i++)
+		free(p->_cls[i]);
+
+	for(int i = 0; i < 2 * f->_n; i++)
+		free(p->_occ[i]);
+
+	free(p->_cls); free(p->_size); free(p->_deleted); free(p->_sig); free(p->_queued);
+	free(p->_occ); free(p->_occ_num); free(p->_occ_cap);
+	free(p->_mark); free(p->_queue); free(p->_units);
+	free(p->_probe); free(p->_trail); free(p->_frozen);
+	free(order);
+	proof_lines_free(&p->_proof);
+
+	return p->_unsat;
+}
+
+// Extend a model of the reduced problem (1 for true and -1 for
+// false, for each symbol) to a model of the original problem
+void extend_model(preprocessor *p, int *model)
+{
+	int end = p->_stack_num;
+
+	while(end > 0)
+	{
+		int len = p->_stack[end - 1];
+		int *clause = p->_stack + end - 1 - len;
+		int sat = 0;
+
+		for(int i = 0; i < len && !sat; i++)
+			sat = (model[_lit_var(clause[i])] == ((_lit_sign(clause[i])) ? (-1) : (1)));
+
+		// Make the first literal true
+		if(!sat)
+			model[_lit_var(clause[0])] = ((_lit_sign(clause[0])) ? (-1) : (1));
+
+		end -= len + 1;
+	}
+}
+
+// Make the problem the algorithms solve from the problem that was read
+// (_input), without any output. Returns 1 if the preprocessing found that
+// the problem is unsatisfiable.
+int prepare_problem(problem *pb)
+{
+	if(!pb->_preprocessing)
+	{
+		copy_cnf(&pb->_cnf, &pb->_input);
+		return 0;
+	}
+
+	return preprocess(&pb->_pre, &pb->_input, &pb->_cnf, pb->_proof);
+}
+
+// prepare_problem, with the outcome of the preprocessing printed
+int preprocess_problem(problem *pb)
+{
+	clock_t t1, t2;
+	int unsat;
+	preprocessor *p = &pb->_pre;
+
+	t1 = clock();
+	unsat = prepare_problem(pb);
+	t2 = clock();
+
+	if(!pb->_preprocessing)
+		return 0;
+
+	printf("Preprocessing: %d clauses -> %d, %ld fixed (%ld failed, %ld implied), %ld substituted, %ld eliminated, "
+		   "%ld subsumed, %ld strengthened, %ld duplicates (%f secs)\n",
+		   pb->_input._m, ((unsat) ? (0) : (pb->_cnf._m)), p->_fixed, p->_failed, p->_implied, p->_substituted,
+		   p->_eliminated_num, p->_subsumed, p->_strengthened, p->_duplicates, ((float) t2 - t1) / CLOCKS_PER_SEC);
+
+	return unsat;
+}
+
+// Read the problem of the file and preprocess it (if _preprocessing
+// is set) into pb->_cnf, keeping the original problem in pb->_input.
+// Returns -1 on errors, 1 if the problem was found unsatisfiable.
+int load_problem(char *filename, problem *pb)
+{
+	if(read_cnf(filename, &pb->_input))
+		return -1;
+
+	return preprocess_problem(pb);
+}
+
+// Extend a model of the reduced problem to the original one (if
+// preprocessing is set) and check it against the original problem
+int finish_model(problem *pb, int *model)
+{
+	int verified;
+
+	if(pb->_preprocessing)
+		extend_model(&pb->_pre, model);
+
+	verified = verify_model(&pb->_input, model);
+
+	if(verified)
+	{
+		if(pb->_model == NULL)
+			pb->_model = (int *) malloc(pb->_input._n * sizeof(int));
+
+		memcpy(pb->_model, model, pb->_input._n * sizeof(int));
+		pb->_answer = ANSWER_SAT;
+	}
+
+	return verified;
+}
+
+// Free a problem loaded by load_problem
+void free_problem(problem *pb)
+{
+	free_cnf(&pb->_input);
+	free_cnf(&pb->_cnf);
+	free(pb->_model);
+	pb->_model = NULL;
+
+	if(pb->_preprocessing)
+	{
+		free(pb->_pre._val);
+		free(pb->_pre._eliminated);
+		free(pb->_pre._stack);
+	}
+}
+
+#endif
@@ -0,0 +1,164 @@
+/*
+	Header file containing the implementation of the ProbSAT algorithm,
+	a local search method similar to WalkSAT. It must be included after
+	the walksat.h file, as it uses the same walk_solver, occurrence lists,
+	break values and search loop.
+
+	ProbSAT picks the literal to flip from an unsatisfied clause, with a
+	probability that only depends on the literal's break value. The
+	probability of each break value is calculated once, in a table, before
+	the search begins, so a step only needs the break values of the clause
+	and a random number. Two functions are supported for the table:
+
+	polynomial:		(eps + break) ^ (-cb)
+	exponential:	cb ^ (-break)
+
+	If cb is not set by the user, a default is selected by the number of
+	literals in the clauses of the input file (before the preprocessing),
+	as proposed in the links below.
+
+	The user needs to first create a walk_solver, like for WalkSAT, and
+	set the function in a prob_data struct (prob_defaults, for the
+	defaults), and then call the probsat function, with a file name (the
+	output file).
+
+	Links used:
+	https://www.uni-ulm.de/fileadmin/website_uni_ulm/iui.inst.190/Mitarbeiter/balint/SAT2012.pdf
+	https://github.com/adrianopolus/probSAT
+
+	Kefsenidis Paraskevas, 2023.
+*/
+
+#define PROB_TABLE_SIZE	64	// Break values above the size use the last entry of the table
+
+// The function of the probability table
+enum prob_function
+{
+	PROB_DEFAULT = 0,		// Selected by K
+	PROB_POLY = 1,
+	PROB_EXP = 2
+};
+
+// The state of ProbSAT, kept in the _data of the walk_solver
+typedef struct prob_data
+{
+	enum prob_function _fn;
+	double _cb;				// The base of the function, 0 to select it by K
+	double _eps;			// Only used by the polynomial function
+
+	double _table[PROB_TABLE_SIZE];		// The probability of each break value
+	double *_clause_probs;				// The probabilities of the literals of a clause (up to K)
+} prob_data;
+
+// Set the function to be selected by K
+void prob_defaults(prob_data *p)
+{
+	p->_fn = PROB_DEFAULT;
+	p->_cb = 0;
+	p->_eps = 0.9;
+}
+
+// Select the function and cb, for the runs where the user
+// did not set them. k is the K of the input file.
+void probsat_defaults(prob_data *p, int k)
+{
+	if(p->_fn == PROB_DEFAULT)
+		p->_fn = ((k <= 3) ? (PROB_POLY) : (PROB_EXP));
+
+	if(p->_cb > 0)
+		return;
+
+	if(p->_fn == PROB_POLY)
+		p->_cb = 2.06;
+	else if(k <= 4)
+		p->_cb = 3.0;
+	else if(k == 5)
+		p->_cb = 3.7;
+	else if(k == 6)
+		p->_cb = 5.1;
+	else
+		p->_cb = 5.4;
+}
+
+// Calculate the probability of each break value
+void init_prob_table(prob_data *p)
+{
+	for(int b = 0; b < PROB_TABLE_SIZE; b++)
+	{
+		if(p->_fn == PROB_POLY)
+			p->_table[b] = pow(p->_eps + b, -p->_cb);
+		else
+			p->_table[b] = pow(p->_cb, -b);
+	}
+}
+
+// Pick a literal of the clause, with the probability
+// of its break value
+int prob_pick_lit(walk_solver *w, int *clause, int len, unsigned char *lit_assign)
+{
+	prob_data *p = (prob_data *) w->_data;
+	double sum = 0;
+	double r;
+	int i;
+
+	// break_count stops counting after min_brk, so the
+	// break values are limited to the size of the table
+	w->_min_brk = PROB_TABLE_SIZE - 1;
+
+	for(i = 0; i < len; i++)
+	{
+		int brk = break_count(w, lit_assign, _lit_var(clause[i]));
+
+		if(brk >= PROB_TABLE_SIZE)
+			brk = PROB_TABLE_SIZE - 1;
+
+		p->_clause_probs[i] = p->_table[brk];
+		sum += p->_clause_probs[i];
+	}
+
+	r = rng_double(&w->_rng) * sum;
+
+	for(i = 0; i < len - 1; i++)
+	{
+		r -= p->_clause_probs[i];
+
+		if(r < 0)
+			break;
+	}
+
+	return _lit_var(clause[i]);
+}
+
+// Set up ProbSAT as the method of the solver w, for a problem that had
+// clauses of k literals (before the preprocessing)
+void probsat_create(walk_solver *w, prob_data *p, int k)
+{
+	p->_clause_probs = (double *) malloc(w->_k * sizeof(double));
+	w->_data = p;
+
+	probsat_defaults(p, k);
+	init_prob_table(p);
+}
+
+void probsat_destroy(walk_solver *w, prob_data *p)
+{
+	free(p->_clause_probs);
+	w->_data = NULL;
+}
+
+// The main body of the ProbSAT algorithm
+void probsat(walk_solver *w, prob_data *p, problem *pb, char *outfname)
+{
+	probsat_create(w, p, pb->_input._k);
+
+	printf("ProbSAT with %s function, cb = %g", ((p->_fn == PROB_POLY) ? ("polynomial") : ("exponential")), p->_cb);
+
+	if(p->_fn == PROB_POLY)
+		printf(", eps = %g", p->_eps);
+
+	printf("\n");
+
+	local_search(w, pb, (local_method) {"ProbSAT", prob_pick_lit, NULL, NULL}, outfname);
+
+	probsat_destroy(w, p);
+}
@@ -0,0 +1,301 @@
+/*
+	Header file containing the writing of proofs of unsatisfiability, in the
+	binary DRAT format, so that an answer of no solution can be checked
+	against the input file by a proof checker (such as drat-trim), without
+	trusting the solver.
+
+	A proof is the list of the clauses the solver added, each one implied by
+	the clauses before it through unit propagation (RUP), and of the clauses
+	it deleted, and it ends with the empty clause. In the binary format each
+	line is the byte 'a' (added) or 'd' (deleted), then the literals and a 0
+	byte. A literal P_i is written as 2 * i and !P_i as 2 * i + 1, 7 bits at
+	a time from the lowest ones, with the high bit set on every byte but the
+	last. That is the code of the literal (see literal.h) plus 2.
+
+	The proof must cost little next to the search, so each thread gathers
+	its lines in its own proof_lines buffer, without a lock, and moves them
+	to the large buffer of the proof when it fills. A thread of the proof
+	writes the other large buffer to the file at the same time, so the
+	solver only waits for the disk when the proof grows faster than the disk
+	writes it. The lines of a proof_lines buffer stay in order, and the
+	threads only solve independent parts of a problem, so the lines of
+	different threads can be mixed.
+
+	In order for this to be used, the user has to call proof_open, give
+	each thread a proof_lines buffer (proof_lines_init, then proof_clause or
+	proof_begin, proof_lit and proof_end for each line, and proof_lines_free
+	at the end), and call proof_close when all of them are done.
+
+	Link used:
+	https://github.com/marijnheule/drat-trim
+
+	Kefsenidis Paraskevas, 2023
+*/
+
+#ifndef PROOF_H
+#define PROOF_H
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define PROOF_BUFFER_BYTES	(8 << 20)	// Each of the two large buffers of a proof
+#define PROOF_LINES_BYTES	(64 << 10)	// The lines of a thread are moved to the proof when they are this long
+
+// A proof being written
+typedef struct proof
+{
+	FILE *_file;
+	pthread_t _thread;
+	pthread_mutex_t _lock;
+	pthread_cond_t _cond;
+
+	// The buffer the lines are moved to, and the buffer the thread
+	// writes, which is empty when _write_len is 0
+	char *_fill;
+	size_t _fill_len;
+	char *_write;
+	size_t _write_len;
+
+	int _closing;			// Set when the thread must write the rest and end
+	int _error;				// Set when the file could not be written
+	int _complete;			// Set when the empty clause was added
+
+	long _added;
+	long _deleted;
+} proof;
+
+// The lines of a thread, not yet moved to the proof
+typedef struct proof_lines
+{
+	proof *_proof;			// NULL when no proof is written
+	unsigned char *_buf;
+	size_t _len;
+	size_t _cap;
+
+	int _complete;
+	long _added;
+	long _deleted;
+} proof_lines;
+
+// The body of the thread of the proof: write each full buffer to the file
+void *proof_writer(void *arg)
+{
+	proof *pf = (proof *) arg;
+
+	pthread_mutex_lock(&pf->_lock);
+
+	while(1)
+	{
+		while(pf->_write_len == 0 && !pf->_closing)
+			pthread_cond_wait(&pf->_cond, &pf->_lock);
+
+		if(pf->_write_len == 0)
+			break;
+
+		pthread_mutex_unlock(&pf->_lock);
+
+		if(fwrite(pf->_write, 1, pf->_write_len, pf->_file) != pf->_write_len)
+			pf->_error = 1;
+
+		pthread_mutex_lock(&pf->_lock);
+		pf->_write_len = 0;
+		pthread_cond_broadcast(&pf->_cond);
+	}
+
+	pthread_mutex_unlock(&pf->_lock);
+
+	return NULL;
+}
+
+// Start writing a proof to the file filename. Returns -1 if it cannot be created.
+int proof_open(proof *pf, char *filename)
+{
+	memset(pf, 0, sizeof(proof));
+
+	if((pf->_file = fopen(filename, "wb")) == NULL)
+	{
+		printf("Cannot create the proof file %s\n", filename);
+		return -1;
+	}
+
+	pf->_fill = (char *) malloc(PROOF_BUFFER_BYTES);
+	pf->_write = (char *) malloc(PROOF_BUFFER_BYTES);
+	pthread_mutex_init(&pf->_lock, NULL);
+	pthread_cond_init(&pf->_cond, NULL);
+
+	if(pthread_create(&pf->_thread, NULL, proof_writer, pf) != 0)
+	{
+		printf("Cannot start the thread of the proof file %s\n", filename);
+		fclose(pf->_file);
+		free(pf->_fill); free(pf->_write);
+		return -1;
+	}
+
+	return 0;
+}
+
+// Give the filled buffer to the thread, after it is done with the previous
+// one. The lock must be held.
+void proof_hand_over(proof *pf)
+{
+	char *tmp;
+
+	while(pf->_write_len > 0)
+		pthread_cond_wait(&pf->_cond, &pf->_lock);
+
+	tmp = pf->_write;
+	pf->_write = pf->_fill;
+	pf->_write_len = pf->_fill_len;
+	pf->_fill = tmp;
+	pf->_fill_len = 0;
+
+	pthread_cond_broadcast(&pf->_cond);
+}
+
+// Move the lines of a thread to the proof
+void proof_flush(proof_lines *pl)
+{
+	proof *pf = pl->_proof;
+
+	if(pf == NULL || pl->_len == 0)
+		return;
+
+	pthread_mutex_lock(&pf->_lock);
+
+	if(pf->_fill_len + pl->_len > PROOF_BUFFER_BYTES)
+		proof_hand_over(pf);
+
+	// Lines longer than a whole buffer (a clause of millions of
+	// literals) are written directly, after the ones before them
+	if(pl->_len > PROOF_BUFFER_BYTES)
+	{
+		while(pf->_write_len > 0)
+			pthread_cond_wait(&pf->_cond, &pf->_lock);
+
+		if(fwrite(pl->_buf, 1, pl->_len, pf->_file) != pl->_len)
+			pf->_error = 1;
+	}
+
+	else
+	{
+		memcpy(pf->_fill + pf->_fill_len, pl->_buf, pl->_len);
+		pf->_fill_len += pl->_len;
+	}
+
+	pf->_added += pl->_added;
+	pf->_deleted += pl->_deleted;
+	pf->_complete |= pl->_complete;
+
+	pthread_mutex_unlock(&pf->_lock);
+
+	pl->_len = 0;
+	pl->_added = pl->_deleted = 0;
+}
+
+// Write the rest of the proof and close it. Returns 1 if the proof
+// is complete (it ends with the empty clause) and was written.
+int proof_close(proof *pf)
+{
+	pthread_mutex_lock(&pf->_lock);
+	proof_hand_over(pf);
+	pf->_closing = 1;
+	pthread_cond_broadcast(&pf->_cond);
+	pthread_mutex_unlock(&pf->_lock);
+
+	pthread_join(pf->_thread, NULL);
+
+	if(fclose(pf->_file) != 0)
+		pf->_error = 1;
+
+	free(pf->_fill); free(pf->_write);
+	pthread_mutex_destroy(&pf->_lock);
+	pthread_cond_destroy(&pf->_cond);
+
+	return pf->_complete && !pf->_error;
+}
+
+// Prepare the lines of a thread, for the proof pf (NULL for no proof)
+void proof_lines_init(proof_lines *pl, proof *pf)
+{
+	memset(pl, 0, sizeof(proof_lines));
+	pl->_proof = pf;
+
+	if(pf != NULL)
+	{
+		pl->_cap = PROOF_LINES_BYTES;
+		pl->_buf = (unsigned char *) malloc(pl->_cap);
+	}
+}
+
+// Move the last lines to the proof and free the buffer
+void proof_lines_free(proof_lines *pl)
+{
+	proof_flush(pl);
+	free(pl->_buf);
+	pl->_buf = NULL;
+	pl->_proof = NULL;
+}
+
+// Start a line of len literals, of type 'a' (added clause) or 'd' (deleted clause)
+void proof_begin(proof_lines *pl, char type, int len)
+{
+	size_t need = 5 * (size_t) len + 2;		// A literal takes at most 5 bytes
+
+	if(pl->_len + need > PROOF_LINES_BYTES)
+		proof_flush(pl);
+
+	if(pl->_len + need > pl->_cap)
+	{
+		pl->_cap = pl->_len + need;
+		pl->_buf = (unsigned char *) realloc(pl->_buf, pl->_cap);
+	}
+
+	pl->_buf[pl->_len++] = type;
+
+	if(type == 'a')
+	{
+		pl->_added++;
+		pl->_complete |= (len == 0);
+	}
+
+	else
+		pl->_deleted++;
+}
+
+// Add the literal with code lit to the line
+void proof_lit(proof_lines *pl, int lit)
+{
+	unsigned int u = (unsigned int) lit + 2;
+
+	while(u > 127)
+	{
+		pl->_buf[pl->_len++] = (unsigned char) ((u & 127) | 128);
+		u >>= 7;
+	}
+
+	pl->_buf[pl->_len++] = (unsigned char) u;
+}
+
+void proof_end(proof_lines *pl)
+{
+	pl->_buf[pl->_len++] = 0;
+}
+
+// Write a whole line, of the len literals (codes) of lits. Nothing
+// is written when no proof is written.
+void proof_clause(proof_lines *pl, char type, int *lits, int len)
+{
+	if(pl->_proof == NULL)
+		return;
+
+	proof_begin(pl, type, len);
+
+	for(int i = 0; i < len; i++)
+		proof_lit(pl, lits[i]);
+
+	proof_end(pl);
+}
+
+#endif
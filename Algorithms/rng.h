@@ -0,0 +1,123 @@
+/*
+	Header file containing a small and fast pseudo random number generator,
+	used by the WalkSAT algorithm and the input file generator instead of
+	the rand() function of the standard library.
+
+	The generator is xoshiro256**, seeded through splitmix64, as described
+	in the links below. Its whole state is kept in an rng struct, so every
+	solver (or thread) can carry its own generator, and the same seed
+	always reproduces the same sequence of numbers.
+
+	Links used:
+	https://prng.di.unimi.it/
+	https://prng.di.unimi.it/splitmix64.c
+	https://lemire.me/blog/2019/06/06/nearly-divisionless-random-integer-generation-on-various-systems/
+
+	Kefsenidis Paraskevas, 2023
+*/
+
+#ifndef RNG_H
+#define RNG_H
+
+#include <stdint.h>
+#include <time.h>
+
+#define _rotl(x, k) (((x) << (k)) | ((x) >> (64 - (k))))
+
+// The state of the generator
+typedef struct rng
+{
+	uint64_t _s[4];
+} rng;
+
+// Step of the splitmix64 generator, used only for seeding
+uint64_t splitmix64(uint64_t *x)
+{
+	uint64_t z = (*x += 0x9e3779b97f4a7c15ULL);
+
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+
+	return z ^ (z >> 31);
+}
+
+// Initialize the state of the generator from a 64 bit seed.
+// The state is never all zeros, because of splitmix64.
+void rng_seed(rng *r, uint64_t seed)
+{
+	for(int i = 0; i < 4; i++)
+		r->_s[i] = splitmix64(&seed);
+}
+
+// A seed for the runs where the user did not provide one
+uint64_t rng_default_seed(void)
+{
+	return (uint64_t) time(NULL) ^ ((uint64_t) clock() << 32);
+}
+
+// Return the next 64 random bits
+uint64_t rng_next(rng *r)
+{
+	uint64_t *s = r->_s;
+	uint64_t result = _rotl(s[1] * 5, 7) * 9;
+	uint64_t t = s[1] << 17;
+
+	s[2] ^= s[0];
+	s[3] ^= s[1];
+	s[1] ^= s[2];
+	s[0] ^= s[3];
+
+	s[2] ^= t;
+	s[3] = _rotl(s[3], 45);
+
+	return result;
+}
+
+// Return a random number from 0 to bound - 1, without the bias
+// of rand() % bound. This is Lemire's multiply and shift method,
+// which only divides when a (rare) rejection may be needed.
+uint32_t rng_bounded(rng *r, uint32_t bound)
+{
+	uint64_t m = (rng_next(r) >> 32) * (uint64_t) bound;
+	uint32_t low = (uint32_t) m;
+
+	if(low < bound)
+	{
+		uint32_t threshold = -bound % bound;
+
+		while(low < threshold)
+		{
+			m = (rng_next(r) >> 32) * (uint64_t) bound;
+			low = (uint32_t) m;
+		}
+	}
+
+	return (uint32_t) (m >> 32);
+}
+
+// Return a random number in [0, 1), with 53 random bits
+double rng_double(rng *r)
+{
+	return (rng_next(r) >> 11) * 0x1.0p-53;
+}
+
+// Convert a probability (0 to 1) to a 32 bit threshold, so that
+// it can be compared against random integers, instead of floats
+uint32_t rng_threshold(double p)
+{
+	if(p <= 0)
+		return 0;
+
+	if(p >= 1)
+		return UINT32_MAX;
+
+	return (uint32_t) (p * 4294967296.0);
+}
+
+// Returns 1 with the probability that the threshold represents
+int rng_chance(rng *r, uint32_t threshold)
+{
+	return (uint32_t) (rng_next(r) >> 32) < threshold;
+}
+
+#endif
@@ -0,0 +1,737 @@
+/*
+	Header file containing the server mode of the solver: a long lived
+	process that listens on a Unix domain socket and solves the problems
+	sent to it, so that many small problems do not each pay for starting
+	a process. It must be included after all the algorithms.
+
+	A connection can send many requests, one after the other, and the
+	server keeps its stream buffers for all of them. The main thread
+	accepts the connections and waits (with poll) for their next request.
+	A connection with a request is queued for a pool of worker threads,
+	and a worker solves one request of it and gives it back, so a
+	connection never keeps a worker while it sends nothing, and many
+	connections share the workers in the order their requests arrive. A
+	request is a line with the method and its options, followed by the
+	problem (in the format of the input files or in the DIMACS format,
+	see read_cnf_stream):
+
+	<method> [--seed <number>] [--timeout <seconds>] [--max-flips <number>]
+	         [--max-tries <number>] [--screen <number>] [--adaptive]
+	         [--no-preprocess] [--jobs <number>]
+
+	The rest of the options are the ones the server was started with. A
+	request without --seed gets a new seed. DPLL uses one thread, unless
+	--jobs is given, as the workers already solve problems in parallel.
+	The --timeout of a request is the time of its whole solve, which the
+	DPLL part of hybrid shares with its WalkSAT part.
+
+	The response is sent as soon as the problem is solved:
+
+	result <SAT|UNSAT|UNKNOWN|ERROR> [message]
+	model <the N values, 1 or -1 (0 for the unassigned symbols of DPLL)>
+	stats <name>=<value> ...
+	end
+
+	UNKNOWN means that the search stopped (step budget, time limit or
+	signal) and the model line then has the best (WalkSAT) or partial
+	(DPLL) assignment. There is no model line for UNSAT and ERROR. After
+	a problem that cannot be read, the connection is closed.
+
+	When the server was started with --cache, each problem is first looked
+	up in the cache (see cache.h), and an answer found there has the stats
+	cache=1. The answers of the other problems are added to the cache.
+
+	A SIGINT or SIGTERM stops the server: the running searches stop and
+	send their responses, and the socket is removed.
+
+	Links used:
+	https://man7.org/linux/man-pages/man7/unix.7.html
+	https://man7.org/linux/man-pages/man2/accept.2.html
+
+	Kefsenidis Paraskevas, 2023
+*/
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+
+#define SERVE_BUFFER	(1 << 16)		// The size of the stream buffers of each connection
+#define SERVE_MAX_ARGS	32				// The most words of a request line
+#define SERVE_POLL_MS	200				// How often the main thread checks for a signal
+#define SERVE_DRAIN_SECS	1			// See serve_connection
+
+// A connection of a client
+typedef struct connection
+{
+	int _fd;
+	FILE *_in;
+	FILE *_out;
+	struct connection *_next;
+} connection;
+
+typedef struct server
+{
+	char *_path;				// The path of the socket
+	int _workers;				// The worker threads (0 for the number of CPUs)
+	int _fd;					// The listening socket
+
+	/*
+		The connections with a request are queued (from _ready_head to
+		_ready_tail) for the workers. A worker that is done with a request
+		puts the connection in _idle, and writes to the _wake pipe, so that
+		the main thread waits for the next request of the connection too.
+	*/
+	pthread_mutex_t _lock;
+	pthread_cond_t _ready_cond;
+	connection *_ready_head;
+	connection *_ready_tail;
+	connection *_idle;
+	int _wake[2];
+	int _stopping;				// Set when the workers must exit
+
+	// The parameters of the command line, copied by each request
+	problem *_pb;
+	walk_solver *_walk;
+	prob_data *_prob;
+	dpll_solver *_dpll;
+	char *_cache;				// The directory of the result cache (see cache.h), NULL if none
+
+	atomic_long _requests;		// Requests served so far (also mixed into the seeds)
+} server;
+
+// walk_result_name, as single words
+char *serve_stop_name[] = {"solved", "step_limit", "time_limit", "interrupted"};
+
+// A request, as it was read by a worker
+typedef struct request
+{
+	char *_method;
+	problem _pb;
+	walk_solver _walk;
+	prob_data _prob;
+	dpll_solver _dpll;
+	char *_error;				// Why the request is wrong, NULL if it is not
+
+	// The response
+	char *_result;
+	int *_model;				// NULL when there is no model line
+	char _stats[256];
+} request;
+
+// Set the parameters of the request from the words of its line, with
+// _error set on the first wrong one. Returns 1 if the seed was given.
+int serve_options(request *r, char **argv, int argc)
+{
+	int seeded = 0;
+
+	for(int i = 1; i < argc && r->_error == NULL; i++)
+	{
+		char *val = ((i + 1 < argc) ? (argv[i + 1]) : (NULL));
+
+		if(strcmp(argv[i], "--adaptive") == 0)
+			r->_walk._adaptive = 1;
+
+		else if(strcmp(argv[i], "--no-preprocess") == 0)
+			r->_pb._preprocessing = 0;
+
+		else if(val == NULL)
+			r->_error = "missing option value";
+
+		else
+		{
+			i++;
+
+			if(strcmp(argv[i - 1], "--seed") == 0)
+			{
+				r->_walk._seed = strtoull(val, NULL, 10);
+				seeded = 1;
+			}
+
+			else if(strcmp(argv[i - 1], "--timeout") == 0)
+			{
+				r->_walk._time_limit = strtod(val, NULL);
+				r->_dpll._time_limit = r->_walk._time_limit;
+			}
+
+			else if(strcmp(argv[i - 1], "--max-flips") == 0)
+				r->_walk._max_flips = strtol(val, NULL, 10);
+
+			else if(strcmp(argv[i - 1], "--max-tries") == 0)
+				r->_walk._max_tries = strtol(val, NULL, 10);
+
+			else if(strcmp(argv[i - 1], "--screen") == 0)
+				r->_walk._screen = strtol(val, NULL, 10);
+
+			else if(strcmp(argv[i - 1], "--jobs") == 0)
+				r->_dpll._jobs = strtol(val, NULL, 10);
+
+			else
+				r->_error = "unknown option";
+		}
+	}
+
+	return seeded;
+}
+
+// The model of the WalkSAT best assignment, with the symbols removed by
+// the preprocessing set. Returns 1 if it satisfies the problem.
+int serve_walk_model(request *r)
+{
+	walk_solver *w = &r->_walk;
+
+	r->_model = (int *) malloc(r->_pb._input._n * sizeof(int));
+
+	for(int i = 0; i < w->_n; i++)
+		r->_model[i] = ((w->_best_assign[i * 2]) ? (1) : (-1));
+
+	return finish_model(&r->_pb, r->_model);
+}
+
+// Solve the problem with dpll and set the response
+void serve_dpll(request *r)
+{
+	dpll_solver *d = &r->_dpll;
+	enum dpll_result result = dpll_solve(d);
+
+	if(result != DPLL_UNSAT)
+	{
+		r->_model = (int *) malloc(r->_pb._input._n * sizeof(int));
+		memcpy(r->_model, d->_model, d->_cnf->_n * sizeof(int));
+	}
+
+	if(result == DPLL_SAT)
+		r->_result = ((finish_model(&r->_pb, r->_model)) ? ("SAT") : ("ERROR model not verified"));
+	else
+		r->_result = ((result == DPLL_UNSAT) ? ("UNSAT") : ("UNKNOWN"));
+
+	if(result == DPLL_UNSAT)
+		r->_pb._answer = ANSWER_UNSAT;
+
+	snprintf(r->_stats, sizeof(r->_stats), "components=%d decisions=%ld unit_props=%ld pure_props=%ld backtracks=%ld",
+			 d->_comp_num, d->_decisions, d->_unit_props, d->_pure_props, d->_backtracks);
+}
+
+// Solve the problem of the request with its method
+void serve_solve(request *r)
+{
+	walk_solver *w = &r->_walk;
+	int walk = (strcmp(r->_method, "dpll") != 0);
+	int dpll = (strcmp(r->_method, "dpll") == 0 || strcmp(r->_method, "hybrid") == 0);
+	enum walk_result result;
+	prob_data *p = &r->_prob;
+	double start = wall_time();
+	cw_data c;
+
+	if(dpll)
+		dpll_create(&r->_dpll, &r->_pb._cnf);
+
+	if(!walk)
+		serve_dpll(r);
+
+	else
+	{
+		walk_create(w, &r->_pb._cnf);
+
+		if(strcmp(r->_method, "probsat") == 0)
+		{
+			probsat_create(w, p, r->_pb._input._k);
+			result = walk_solve(w, (local_method) {"ProbSAT", prob_pick_lit, NULL, NULL});
+			probsat_destroy(w, p);
+		}
+
+		// (WalkSAT, for cardinality constraints, see cwls.h)
+		else if(strcmp(r->_method, "cwls") == 0 && w->_c == 0)
+		{
+			cw_create(w, &c);
+			result = walk_solve(w, (local_method) {"CWLS", cw_pick_lit, cw_start, cw_flipped});
+			cw_destroy(w, &c);
+		}
+
+		else
+		{
+			walk_noise_init(w);
+			result = walk_solve(w, (local_method) {"WalkSAT", pick_lit, NULL, NULL});
+		}
+
+		// The time limit is the one of the whole request, so DPLL
+		// has the rest of it
+		if(dpll && w->_time_limit > 0)
+		{
+			r->_dpll._time_limit = w->_time_limit - (wall_time() - start);
+
+			if(r->_dpll._time_limit <= 0)
+				result = WALK_TIMEOUT;
+		}
+
+		// The hybrid method goes on with DPLL, unless WalkSAT is done
+		if(dpll && result != WALK_SOLVED && result != WALK_INTERRUPTED && result != WALK_TIMEOUT)
+		{
+			char walk_stats[128];
+
+			snprintf(walk_stats, sizeof(walk_stats), " walk_unsat_clauses=%d walk_steps=%ld", w->_best_false, w->_steps);
+
+			hybrid_phase(w, &r->_dpll);
+			serve_dpll(r);
+			strncat(r->_stats, walk_stats, sizeof(r->_stats) - strlen(r->_stats) - 1);
+
+			free(r->_dpll._phase);
+			r->_dpll._phase = NULL;
+		}
+
+		else
+		{
+			if(serve_walk_model(r))
+				r->_result = "SAT";
+			else
+				r->_result = ((result == WALK_SOLVED) ? ("ERROR model not verified") : ("UNKNOWN"));
+
+			snprintf(r->_stats, sizeof(r->_stats), "stop=%s unsat_clauses=%d tries=%d steps=%ld",
+					 serve_stop_name[result], w->_best_false, w->_tries, w->_steps);
+		}
+
+		walk_destroy(w);
+	}
+
+	if(dpll)
+		dpll_destroy(&r->_dpll);
+}
+
+// Read the problem of a request, solve it and send the response. Returns
+// -1 if the problem could not be read, so the connection must be closed.
+int serve_request(server *sv, char *line, FILE *in, FILE *out)
+{
+	char *argv[SERVE_MAX_ARGS];
+	int argc = 0;
+	char *save;
+	request r;
+	cache_key key;
+	int hit = 0;
+	long number = atomic_fetch_add(&sv->_requests, 1);
+	double t1, t2;
+
+	memset(&r, 0, sizeof(request));
+	r._pb._preprocessing = sv->_pb->_preprocessing;
+	r._walk = *sv->_walk;
+	r._prob = *sv->_prob;
+	r._dpll = *sv->_dpll;
+
+	if(r._dpll._jobs == 0)
+		r._dpll._jobs = 1;
+
+	for(char *word = strtok_r(line, " \t\r\n", &save); word != NULL && argc < SERVE_MAX_ARGS;
+		word = strtok_r(NULL, " \t\r\n", &save))
+		argv[argc++] = word;
+
+	r._method = argv[0];
+
+	if(!serve_options(&r, argv, argc))
+		r._walk._seed = rng_default_seed() ^ ((uint64_t) number * 0x9E3779B97F4A7C15ULL);
+
+	if(strcmp(r._method, "dpll") != 0 && strcmp(r._method, "walk") != 0 && strcmp(r._method, "probsat") != 0 &&
+	   strcmp(r._method, "cwls") != 0 && strcmp(r._method, "hybrid") != 0)
+		r._error = "unknown method";
+
+	// The problem is read even after a wrong request line, so that
+	// the next request starts where it should
+	if(read_cnf_stream(in, &r._pb._input))
+	{
+		fprintf(out, "result ERROR the problem cannot be read\nend\n");
+		return -1;
+	}
+
+	t1 = wall_time();
+
+	if(r._error != NULL)
+	{
+		fprintf(out, "result ERROR %s\nend\n", r._error);
+		free_cnf(&r._pb._input);
+		return 0;
+	}
+
+	if(sv->_cache != NULL)
+	{
+		cache_key_make(&key, &r._pb._input, sv->_cache);
+		hit = cache_lookup(&key, &r._pb);
+	}
+
+	if(hit)
+	{
+		r._result = ((r._pb._answer == ANSWER_SAT) ? ("SAT") : ("UNSAT"));
+		r._model = r._pb._model;
+		r._pb._model = NULL;
+		strcpy(r._stats, "cache=1");
+	}
+
+	else if(prepare_problem(&r._pb))
+	{
+		r._result = "UNSAT";
+		r._pb._answer = ANSWER_UNSAT;
+		strcpy(r._stats, "preprocessing=1");
+	}
+
+	else
+		serve_solve(&r);
+
+	if(sv->_cache != NULL)
+	{
+		if(!hit)
+			cache_store(&key, &r._pb);
+
+		cache_key_free(&key);
+	}
+
+	t2 = wall_time();
+
+	fprintf(out, "result %s\n", r._result);
+
+	if(r._model != NULL)
+	{
+		fputs("model", out);
+
+		for(int i = 0; i < r._pb._input._n; i++)
+			fprintf(out, " %d", r._model[i]);
+
+		fputc('\n', out);
+	}
+
+	fprintf(out, "stats method=%s time=%f seed=%llu %s\nend\n", r._method, t2 - t1,
+			(unsigned long long) r._walk._seed, r._stats);
+
+	free(r._model);
+	free_problem(&r._pb);
+
+	return 0;
+}
+
+void close_connection(connection *c)
+{
+	fclose(c->_out);
+	fclose(c->_in);
+	free(c);
+}
+
+// Queue a connection with a request for the workers (with the lock held)
+void push_ready(server *sv, connection *c)
+{
+	c->_next = NULL;
+
+	if(sv->_ready_tail != NULL)
+		sv->_ready_tail->_next = c;
+	else
+		sv->_ready_head = c;
+
+	sv->_ready_tail = c;
+	pthread_cond_signal(&sv->_ready_cond);
+}
+
+// If the next request of the connection (or its end) can be read without
+// waiting. The stream may already hold it, where poll cannot see it.
+int serve_pending(connection *c)
+{
+	int flags = fcntl(c->_fd, F_GETFL);
+	int ch;
+	int pending;
+
+	fcntl(c->_fd, F_SETFL, flags | O_NONBLOCK);
+
+	ch = fgetc(c->_in);
+	pending = (ch != EOF || feof(c->_in));
+
+	if(ch != EOF)
+		ungetc(ch, c->_in);
+	else if(!feof(c->_in))
+		clearerr(c->_in);
+
+	fcntl(c->_fd, F_SETFL, flags);
+
+	return pending;
+}
+
+// Serve the next request of a connection. Returns -1 if the connection
+// must be closed.
+int serve_next(server *sv, connection *c)
+{
+	char line[1024];
+
+	// The empty lines between the requests are skipped
+	do
+	{
+		if(fgets(line, sizeof(line), c->_in) == NULL)
+			return -1;
+	}
+	while(strspn(line, " \t\r\n") == strlen(line));
+
+	if(serve_request(sv, line, c->_in, c->_out) < 0)
+	{
+		// The rest of what the client sends is read (for at most
+		// SERVE_DRAIN_SECS), as closing a socket with unread data
+		// resets the connection and the client may lose the response
+		struct timeval tv = {SERVE_DRAIN_SECS, 0};
+		char drain[4096];
+
+		fflush(c->_out);
+		shutdown(c->_fd, SHUT_WR);
+		setsockopt(c->_fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+		while(fread(drain, 1, sizeof(drain), c->_in) > 0);
+
+		return -1;
+	}
+
+	fflush(c->_out);
+
+	return ((interrupted) ? (-1) : (0));
+}
+
+// The body of each worker: serve one request of each queued connection
+void *serve_worker(void *arg)
+{
+	server *sv = (server *) arg;
+
+	while(1)
+	{
+		connection *c;
+
+		pthread_mutex_lock(&sv->_lock);
+
+		while(sv->_ready_head == NULL && !sv->_stopping)
+			pthread_cond_wait(&sv->_ready_cond, &sv->_lock);
+
+		if(sv->_ready_head == NULL)
+		{
+			pthread_mutex_unlock(&sv->_lock);
+			break;
+		}
+
+		c = sv->_ready_head;
+		sv->_ready_head = c->_next;
+
+		if(sv->_ready_head == NULL)
+			sv->_ready_tail = NULL;
+
+		pthread_mutex_unlock(&sv->_lock);
+
+		// After a signal, the requests that did not start are not read
+		if(sv->_stopping || serve_next(sv, c) < 0)
+		{
+			close_connection(c);
+			continue;
+		}
+
+		pthread_mutex_lock(&sv->_lock);
+
+		// A request that has already arrived goes to the end of the queue
+		if(serve_pending(c))
+			push_ready(sv, c);
+
+		else
+		{
+			c->_next = sv->_idle;
+			sv->_idle = c;
+
+			// When the pipe is full, the main thread wakes up anyway
+			if(write(sv->_wake[1], "", 1) < 0 && errno != EAGAIN)
+				perror("write");
+		}
+
+		pthread_mutex_unlock(&sv->_lock);
+	}
+
+	return NULL;
+}
+
+// Accept the new connections of the listening socket
+void serve_accept(server *sv, connection ***idle, int *idle_num, int *idle_cap)
+{
+	int fd;
+
+	while((fd = accept(sv->_fd, NULL, NULL)) >= 0)
+	{
+		connection *c = (connection *) malloc(sizeof(connection));
+
+		c->_fd = fd;
+		c->_in = fdopen(fd, "r");
+		c->_out = fdopen(dup(fd), "w");
+		setvbuf(c->_in, NULL, _IOFBF, SERVE_BUFFER);
+		setvbuf(c->_out, NULL, _IOFBF, SERVE_BUFFER);
+
+		if(*idle_num == *idle_cap)
+		{
+			*idle_cap = ((*idle_cap) ? (*idle_cap * 2) : (16));
+			*idle = (connection **) realloc(*idle, *idle_cap * sizeof(connection *));
+		}
+
+		(*idle)[(*idle_num)++] = c;
+	}
+}
+
+// Wait for new connections and for the requests of the idle ones, and
+// queue them for the workers, until a signal
+void serve_dispatch(server *sv)
+{
+	connection **idle = NULL;		// The connections the main thread waits on
+	int idle_num = 0, idle_cap = 0;
+	struct pollfd *pfd = NULL;
+	int pfd_cap = 0;
+
+	while(!interrupted)
+	{
+		char buf[64];
+		int num = 0;
+
+		// Take the connections the workers gave back
+		pthread_mutex_lock(&sv->_lock);
+
+		while(sv->_idle != NULL)
+		{
+			connection *c = sv->_idle;
+
+			sv->_idle = c->_next;
+
+			if(idle_num == idle_cap)
+			{
+				idle_cap = ((idle_cap) ? (idle_cap * 2) : (16));
+				idle = (connection **) realloc(idle, idle_cap * sizeof(connection *));
+			}
+
+			idle[idle_num++] = c;
+		}
+
+		pthread_mutex_unlock(&sv->_lock);
+
+		if(pfd_cap < idle_num + 2)
+		{
+			pfd_cap = idle_num + 2;
+			pfd = (struct pollfd *) realloc(pfd, pfd_cap * sizeof(struct pollfd));
+		}
+
+		pfd[0] = (struct pollfd) {sv->_fd, POLLIN, 0};
+		pfd[1] = (struct pollfd) {sv->_wake[0], POLLIN, 0};
+
+		for(int i = 0; i < idle_num; i++)
+			pfd[i + 2] = (struct pollfd) {idle[i]->_fd, POLLIN, 0};
+
+		if(poll(pfd, idle_num + 2, SERVE_POLL_MS) <= 0)
+			continue;
+
+		if(pfd[1].revents)
+			while(read(sv->_wake[0], buf, sizeof(buf)) == sizeof(buf));
+
+		// The connections with a request (or closed) go to the workers
+		pthread_mutex_lock(&sv->_lock);
+
+		for(int i = 0; i < idle_num; i++)
+		{
+			if(pfd[i + 2].revents)
+				push_ready(sv, idle[i]);
+			else
+				idle[num++] = idle[i];
+		}
+
+		pthread_mutex_unlock(&sv->_lock);
+
+		idle_num = num;
+
+		if(pfd[0].revents)
+			serve_accept(sv, &idle, &idle_num, &idle_cap);
+	}
+
+	for(int i = 0; i < idle_num; i++)
+		close_connection(idle[i]);
+
+	free(idle); free(pfd);
+}
+
+// Listen on the socket and serve the requests, until a SIGINT or SIGTERM.
+// Returns -1 if the socket cannot be created.
+int serve(server *sv)
+{
+	struct sockaddr_un addr;
+	struct stat st;
+	int workers = ((sv->_workers > 0) ? (sv->_workers) : ((int) sysconf(_SC_NPROCESSORS_ONLN)));
+	pthread_t *threads;
+	int started = 0;
+
+	if(strlen(sv->_path) >= sizeof(addr.sun_path))
+	{
+		printf("The socket path is too long. Now exiting...\n");
+		return -1;
+	}
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	strcpy(addr.sun_path, sv->_path);
+
+	// A socket left by a server that did not exit is replaced
+	if(stat(sv->_path, &st) == 0 && S_ISSOCK(st.st_mode))
+		unlink(sv->_path);
+
+	sv->_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+
+	if(sv->_fd < 0 || bind(sv->_fd, (struct sockaddr *) &addr, sizeof(addr)) < 0 || listen(sv->_fd, 128) < 0 ||
+	   pipe(sv->_wake) < 0)
+	{
+		printf("Cannot listen on %s: %s. Now exiting...\n", sv->_path, strerror(errno));
+
+		if(sv->_fd >= 0)
+			close(sv->_fd);
+
+		return -1;
+	}
+
+	// The main thread waits with poll, so nothing it reads may block
+	fcntl(sv->_fd, F_SETFL, fcntl(sv->_fd, F_GETFL) | O_NONBLOCK);
+	fcntl(sv->_wake[0], F_SETFL, O_NONBLOCK);
+	fcntl(sv->_wake[1], F_SETFL, O_NONBLOCK);
+
+	// A client that leaves before its response must not stop the server
+	signal(SIGPIPE, SIG_IGN);
+
+	pthread_mutex_init(&sv->_lock, NULL);
+	pthread_cond_init(&sv->_ready_cond, NULL);
+	sv->_ready_head = sv->_ready_tail = sv->_idle = NULL;
+	sv->_stopping = 0;
+	atomic_store(&sv->_requests, 0);
+
+	printf("Listening on %s with %d workers\n", sv->_path, workers);
+	fflush(stdout);
+
+	threads = (pthread_t *) malloc(workers * sizeof(pthread_t));
+
+	for(; started < workers; started++)
+		if(pthread_create(&threads[started], NULL, serve_worker, sv) != 0)
+			break;
+
+	serve_dispatch(sv);
+
+	// The workers finish their requests (stopped by the signal) and exit
+	pthread_mutex_lock(&sv->_lock);
+	sv->_stopping = 1;
+	pthread_cond_broadcast(&sv->_ready_cond);
+	pthread_mutex_unlock(&sv->_lock);
+
+	for(int i = 0; i < started; i++)
+		pthread_join(threads[i], NULL);
+
+	while(sv->_idle != NULL)
+	{
+		connection *c = sv->_idle;
+
+		sv->_idle = c->_next;
+		close_connection(c);
+	}
+
+	close(sv->_fd); close(sv->_wake[0]); close(sv->_wake[1]);
+	unlink(sv->_path);
+	free(threads);
+	pthread_mutex_destroy(&sv->_lock);
+	pthread_cond_destroy(&sv->_ready_cond);
+
+	printf("\nServed %ld requests\n", atomic_load(&sv->_requests));
+
+	return 0;
+}
@@ -3,11 +3,26 @@
 	This version of the algorithm, uses the 0-break values.
 	It also contains some helper functions.
 
-	The user needs to first call the walk_init function, with a file
-	name (the input file) as a parameter, so that information concerning 
-	the problem will be stored in the global arrays. Then call the walksat
-	function with a file name (the output file).
+	All the state of a search is kept in a walk_solver struct, so that
+	many searches can run in the same process (or on different threads).
+	The user needs to first call walk_defaults, then change the parameters
+	of the search (the seed, the budget through _max_flips, _max_tries and
+	_time_limit, _adaptive for adaptive noise instead of the fixed P and
+	_screen, to start each try from the best of _screen random
+	assignments) and call walk_create with a problem (see load_problem).
+	Then walksat runs the search and writes the solution to a file (the
+	output file), or walk_solve runs it without any output. walk_destroy
+	frees the solver. The same seed always leads to the same search.
 	The two files, have the same format as the ones from the bcsp.c file.
+	Unless preprocessing is unset, the problem is first made smaller (see
+	preprocess.h), so the clauses do not all have K literals.
+
+	The cardinality constraints (see cnf.h) are kept with the clauses: a
+	constraint with more true literals than its bound is unsatisfied, like
+	a false clause, and when it is picked, the literal to flip is picked
+	from its true literals. Flipping a literal to true breaks the
+	constraints that are at their bound, so they are added to its break
+	value. The random starts are screened on the clauses only.
 
 	Input File:
 	1st row: N M K
@@ -33,472 +48,968 @@
 #include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
+#include "rng.h"
+#include "interrupt.h"
+#include "literal.h"
+#include "bitslice.h"
+#include "checkpoint.h"
+#include "preprocess.h"
 
-#define _empty(head) head == NULL		// Check if list empty
-#define _reset(head) head = NULL		// Completely empty a list
-#define _create_node(nd, lit) nd->_lit = lit; nd->_next = NULL;
-
-#define _liti(lit) lit._lit_num			// It's is similar to saying Pi, where Pi is the literal
-#define _truth_val(lit) lit._truth_val	// The truth value af a literal
-
-// Checks whether a literal is positive and true or negativee and false. The lit_opt
-// is the literal's number in the Problem and it can define if there is a not sign 
-// in front of the lteral or not.
-#define _neg_pos_truth_istrue(lit_opt, lit_assign) ((lit_opt > 0 && _truth_val(lit_assign[lit_opt - 1])) ||		\
-													(lit_opt < 0 && !_truth_val(lit_assign[-lit_opt - 1])))
-// Flip the truth value of a literal (from false to true and from true to false)
-#define _flip_truth_val(lit) ((_truth_val(lit)) ?		\
-							  (_truth_val(lit) = 0) :	\
-							  (_truth_val(lit) = 1))
+// Flip the truth value of the symbol lit_num (from false to true and from true
+// to false). Both of its literals are flipped in the truth array.
+#define _flip_truth_val(lit_num, lit_assign) ((lit_assign)[(lit_num) * 2] ^= 1, (lit_assign)[(lit_num) * 2 + 1] ^= 1)
 
 #define MAXP	1 		// The max value of a probability
+#define TIME_CHECK_MASK	1023	// The time limit is checked every 1024 steps
 #define P		0.567	// The first link verifies this as a good value.
 
-int N;			// Number of literals
-int K;			// Number of literals in disjunctive clauses
-int M;			// Number of disjunctive clauses
+// Parameters of the adaptive noise, as proposed by Hoos (see walksat)
+#define ADAPT_THETA	(1.0 / 6)	// Steps without improvement (as a fraction of M) before raising the noise
+#define ADAPT_PHI	0.2			// How much the noise is raised (and half of it, lowered)
+
+// The literals and the length of clause i
+#define _clause_of(w, i) ((w)->_problem + (w)->_clause_start[i])
+#define _len_of(w, i) ((w)->_clause_start[(i) + 1] - (w)->_clause_start[i])
+
+// How the search ended
+enum walk_result
+{
+	WALK_SOLVED = 0,		// A solution was found
+	WALK_STEP_LIMIT = 1,	// All tries used their max_flips
+	WALK_TIMEOUT = 2,		// The time limit was reached
+	WALK_INTERRUPTED = 3	// A SIGINT or SIGTERM was received
+};
+
+char *walk_result_name[] = {"solution found", "step budget exhausted", "time limit reached", "interrupted"};
+
+// The state of a local search
+typedef struct walk_solver
+{
+	int _n;					// Number of literals
+	int _k;					// Number of literals in the longest disjunctive clause
+	int _m;					// Number of disjunctive clauses
+
+	int *_problem;			// Deescription of the problem. The literals are stored as codes (see literal.h)
+	int *_clause_start;		// The first literal of each clause in the _problem (M + 1)
+
+	/*
+		The cardinality constraints (see cnf.h). Constraint i is number M + i
+		in _false_clauses and _false_pos, and _card_true holds the number of
+		its true literals. _card_occ lists the constraints of each literal,
+		like _occ, and _card_pick holds the true literals of the constraint
+		picked in a step.
+	*/
+	int _c;
+	int *_card_lits;
+	int *_card_start;
+	int *_card_bound;
+	int *_card_true;
+	int *_card_occ_start;
+	int *_card_occ;
+	int *_card_pick;
+
+	/*
+		The budget of the search. Each try starts from a new random
+		assignment and makes at most _max_flips flips. The whole search
+		(all tries) stops after _time_limit seconds of wall clock time,
+		if _time_limit is positive.
+	*/
+	long _max_flips;
+	int _max_tries;
+	double _time_limit;
+	long _screen;			// Random assignments screened for the start of each try (0 for one)
+
+	rng _rng;				// The random number generator of the search
+	uint64_t _seed;			// The seed the generator was initialized with
+	uint32_t _p_threshold;	// P as a threshold for rng_chance
+
+	/*
+		With adaptive noise, P is not fixed. The noise (1 - P, the probability
+		of picking a random literal of the clause, when there is no 0-break
+		literal) starts from 0 and is raised when the number of unsatisfied
+		clauses has not improved for ADAPT_THETA * M steps, while it is lowered
+		on every improvement.
+	*/
+	int _adaptive;
+	double _noise;
+	int _adapt_false;		// The unsatisfied clauses when the noise was last changed
+	long _adapt_steps;		// Steps since the noise was last changed
+
+	/*
+		Occurrence lists of the literals. The clauses containing the literal
+		with code c are _occ[_occ_start[c]] up to _occ[_occ_start[c + 1] - 1], so
+		the clauses containing Pi are followed by the ones containing !Pi.
+	*/
+	int *_occ_start;
+	int *_occ;
+
+	/*
+		Incremental information about the current assignment, updated on
+		every flip, so that the search never has to scan the whole problem.
+		_true_num holds the number of true literals of each clause, while
+		_false_clauses holds the _false_num clauses that are not satisfied.
+		_false_pos[c] is the position of clause c in _false_clauses.
+	*/
+	int *_true_num;
+	int *_false_clauses;
+	int *_false_pos;
+	int _false_num;
+
+	/*
+		Working buffers of the search, allocated once by walk_create, so that
+		the main loop of walksat does not need to allocate any memory.
+		_min_brk_lits holds the numbers of the literals (of the selected clause)
+		with the same break value, that is also the minimum one. It can hold
+		at most K literals, as many as the literals of a clause.
+	*/
+	int _min_brk;					// The minimum break value
+	int *_min_brk_lits;
+	int _min_brk_size;				// Number of literals stored in _min_brk_lits
+	unsigned char *_assignment;		// The current truth value assignment (2 * N literals, indexed by code)
+	unsigned char *_best_assign;	// The assignment with the fewest unsatisfied clauses so far
+	int _best_false;				// The number of unsatisfied clauses of _best_assign
+
+	/*
+		_best_assign is not copied on every improvement, as that would cost N
+		per improvement. Instead the literals flipped since _best_assign was last
+		updated are kept in _flipped, and only these are flipped in _best_assign
+		when a better assignment is found. When more than N literals have been
+		flipped (or a new try starts), _flipped_num is set to N + 1 and the whole
+		assignment is copied instead.
+	*/
+	int *_flipped;
+	int _flipped_num;
+
+	/*
+		Bit-sliced assignments (see bitslice.h), used to screen many random
+		starting assignments at once. Only allocated when _screen is set.
+	*/
+	uint64_t *_slices;			// SLICE_WORDS words for each literal (2 * N)
+	uint64_t *_slice_counts;	// The counters of unsatisfied clauses of the lanes
+	int _count_planes;
+
+	// Statistics of the last search
+	int _tries;
+	long _steps;				// Steps of all the tries
 
-int min_brk;	// The minimum break value
+	void *_data;				// The state of the method (see probsat.h and cwls.h)
+	checkpoint *_checkpoint;	// Where the state of the search is saved (see walk_save), NULL for none
+} walk_solver;
 
-int *Problem;	// Deescription of the problem.
+// Add a literal at the end of the min_brk_lits buffer
+void push_min_brk(walk_solver *w, int lit_num)
+{
+	w->_min_brk_lits[w->_min_brk_size++] = lit_num;
+}
+
+// Select a literal of the min_brk_lits buffer and return
+// its number. First literal is at index 0
+int select_nd(walk_solver *w, int pos)
+{
+	return w->_min_brk_lits[pos];
+}
 
 /*
-	Below are two arrays, of size M * N (later allocated). These two
-	are used for determining in which clause is each literal present.
-	The first one refers to literals without the not sign, while the
-	second refers to literals with the not sign. For example if 
-	pos_lit_in[2 * N + 1] = true, then the clause number 3 (starting from 0)
-	contains the literal P2, without a not sign.
+	Clause kernels. The body of each kernel is written once, as a macro
+	with the length of the clause as a parameter, and it is generated for
+	lengths 2, 3 and 4, where the length is a constant, so the compiler
+	unrolls the loops, and for any length (generic). The functions below
+	the kernels select one by the length of each clause, as the clauses of
+	a preprocessed problem have different lengths. As the truth array is
+	indexed by the code of the literal, the truth value of a literal is a
+	single load.
 */
-int *pos_lit_in;
-int *neg_lit_in;
+#define _lit_is_true(code, lit_assign) ((lit_assign)[code])
 
-// Struct for literal info
-typedef struct literal
+// Calculate the number of true literals in a clause.
+// The function can also be used to check the truth value
+// of entire clauses.
+#define _define_true_lits_in(name, k)						\
+int name(int *clause, int len, unsigned char *lit_assign)	\
+{															\
+	int true_lits = 0;										\
+	(void) len;												\
+															\
+	for(int i = 0; i < (k); i++)							\
+		true_lits += _lit_is_true(clause[i], lit_assign);	\
+															\
+	return true_lits;										\
+}
+
+// Check if a clause has a truth value of true or false.
+// The method returns this truth value. (the clause is
+// a disjunctive clause)
+#define _define_clause_satisfaction(name, k)				\
+int name(int *clause, int len, unsigned char *lit_assign)	\
+{															\
+	int truth_val = 0;										\
+	(void) len;												\
+															\
+	for(int i = 0; i < (k); i++)							\
+		truth_val |= _lit_is_true(clause[i], lit_assign);	\
+															\
+	return truth_val;										\
+}
+
+_define_true_lits_in(true_lits_in_generic, len)
+_define_true_lits_in(true_lits_in_2, 2)
+_define_true_lits_in(true_lits_in_3, 3)
+_define_true_lits_in(true_lits_in_4, 4)
+
+_define_clause_satisfaction(clause_satisfaction_generic, len)
+_define_clause_satisfaction(clause_satisfaction_2, 2)
+_define_clause_satisfaction(clause_satisfaction_3, 3)
+_define_clause_satisfaction(clause_satisfaction_4, 4)
+
+// Select the kernel by the length of the clause
+int true_lits_in(int *clause, int len, unsigned char *lit_assign)
 {
-	int _lit_num;
-	int _truth_val;
-} literal;
+	switch(len)
+	{
+		case 2:
+			return true_lits_in_2(clause, len, lit_assign);
+		case 3:
+			return true_lits_in_3(clause, len, lit_assign);
+		case 4:
+			return true_lits_in_4(clause, len, lit_assign);
+		default:
+			return true_lits_in_generic(clause, len, lit_assign);
+	}
+}
 
-typedef struct node
+int clause_satisfaction(int *clause, int len, unsigned char *lit_assign)
 {
-	literal _lit;
-	struct node *_next;
-} node;
+	switch(len)
+	{
+		case 2:
+			return clause_satisfaction_2(clause, len, lit_assign);
+		case 3:
+			return clause_satisfaction_3(clause, len, lit_assign);
+		case 4:
+			return clause_satisfaction_4(clause, len, lit_assign);
+		default:
+			return clause_satisfaction_generic(clause, len, lit_assign);
+	}
+}
 
-// A list node is a node, currently part of a list.
-typedef node list_node;
+// Add a clause to the unsatisfied ones
+void add_false(walk_solver *w, int clause_num)
+{
+	w->_false_pos[clause_num] = w->_false_num;
+	w->_false_clauses[w->_false_num++] = clause_num;
+}
 
-// The head of the lst. t oints to the first noode of thee list.
-typedef struct list_head
+// Remove a clause from the unsatisfied ones, by moving the
+// last unsatisfied clause in its position
+void remove_false(walk_solver *w, int clause_num)
 {
-	list_node *_first;
-	int _size;
-} list_head;
+	int last = w->_false_clauses[--w->_false_num];
 
-// List for storing literals with the same
-// break val, that is also the minimum one.
-list_head *min_brk_lits = NULL;
+	w->_false_clauses[w->_false_pos[clause_num]] = last;
+	w->_false_pos[last] = w->_false_pos[clause_num];
+}
 
-// Add node at the head of a list
-int shift(literal lit)
+// Calculate true_num and the unsatisfied clauses from scratch.
+// Used once at the beginning of each try.
+void init_counters(walk_solver *w, unsigned char *lit_assign)
 {
-	node *nd = (node *) malloc(sizeof(node));
-
-	_create_node(nd, lit);
+	w->_false_num = 0;
 
-	if(_empty(min_brk_lits))
+	for(int i = 0; i < w->_m; i++)
 	{
-		min_brk_lits = (list_head *) malloc(sizeof(list_head));
+		w->_true_num[i] = true_lits_in(_clause_of(w, i), _len_of(w, i), lit_assign);
 
-		min_brk_lits->_first = nd;
-		min_brk_lits->_size = 1;
-
-		return 1;
+		if(w->_true_num[i] == 0)
+			add_false(w, i);
 	}
 
-	// Insert new node in the list, at the head:
-	nd->_next = min_brk_lits->_first;
-	min_brk_lits->_first = nd;
-	min_brk_lits->_size++;
+	for(int i = 0; i < w->_c; i++)
+	{
+		w->_card_true[i] = true_lits_in(w->_card_lits + w->_card_start[i], w->_card_start[i + 1] - w->_card_start[i], lit_assign);
 
-	return 1;
+		if(w->_card_true[i] > w->_card_bound[i])
+			add_false(w, w->_m + i);
+	}
 }
 
-// Select a node and return its value.
-// First node is at index 0
-literal select_nd(int pos)
+// Flip the truth value of a literal and update the number of
+// true literals of the clauses it is in.
+void flip(walk_solver *w, int lit_num, unsigned char *lit_assign)
 {
-	list_node *lnd = min_brk_lits->_first;
+	int made, broken;		// The occurrence lists of the literals that become true and false
+
+	_flip_truth_val(lit_num, lit_assign);
+
+	if(w->_flipped_num < w->_n)
+		w->_flipped[w->_flipped_num++] = lit_num;
+	else
+		w->_flipped_num = w->_n + 1;
 
-	for(int i = 0; i < pos; i++)
-		lnd = lnd->_next;
+	made = _true_lit(lit_num, lit_assign[lit_num * 2]);
+	broken = _lit_neg(made);
 
-	return lnd->_lit;
+	for(int i = w->_occ_start[made]; i < w->_occ_start[made + 1]; i++)
+		if(w->_true_num[w->_occ[i]]++ == 0)
+			remove_false(w, w->_occ[i]);
+
+	for(int i = w->_occ_start[broken]; i < w->_occ_start[broken + 1]; i++)
+		if(--w->_true_num[w->_occ[i]] == 0)
+			add_false(w, w->_occ[i]);
+
+	// A constraint is unsatisfied when it goes over its bound
+	for(int i = w->_card_occ_start[made]; i < w->_card_occ_start[made + 1]; i++)
+		if(w->_card_true[w->_card_occ[i]]++ == w->_card_bound[w->_card_occ[i]])
+			add_false(w, w->_m + w->_card_occ[i]);
+
+	for(int i = w->_card_occ_start[broken]; i < w->_card_occ_start[broken + 1]; i++)
+		if(--w->_card_true[w->_card_occ[i]] == w->_card_bound[w->_card_occ[i]])
+			remove_false(w, w->_m + w->_card_occ[i]);
 }
 
-// Calculate the number of true literals in a clause. 
-// The function can also be used to check the truth value
-// of entire clauses.
-int true_lits_in(int *clause, literal *lit_assign)
+// Make the current assignment the best one
+void save_best(walk_solver *w, unsigned char *lit_assign)
 {
-	int true_lits = 0;
-
-	for(int i = 0; i < K; i++)
-		if(_neg_pos_truth_istrue(clause[i], lit_assign))
-			true_lits++;
+	if(w->_flipped_num > w->_n)
+		memcpy(w->_best_assign, lit_assign, 2 * w->_n * sizeof(unsigned char));
+	else
+		for(int i = 0; i < w->_flipped_num; i++)
+			_flip_truth_val(w->_flipped[i], w->_best_assign);
 
-	return true_lits;
+	w->_flipped_num = 0;
+	w->_best_false = w->_false_num;
 }
 
 // Calculate the break value of a literal
-int break_count(int *clause, literal *lit_assign, int lit_num)
+int break_count(walk_solver *w, unsigned char *lit_assign, int lit_num)
 {
 	int break_val = 0;
+	int true_occ;		// The occurrence list of the literal that is now true
 
 	/*
 		The concept here is to find the number of clauses
-		whose truth values are solely depedent on the selected 
+		whose truth values are solely depedent on the selected
 		literal. This can happen when the selected literal is the only
 		literal in the clause that returns a truth value of true, whether
-		it is a positive or a negative literal, which differ only in the 
+		it is a positive or a negative literal, which differ only in the
 		search front.
 	*/
 
-	// Check whether the literal has a truth value of true, or false
-	if(_truth_val(lit_assign[abs(lit_num)]))
+	// If Pi is true, search the clauses containing Pi, otherwise
+	// the clauses containing !Pi.
+	true_occ = _true_lit(lit_num, lit_assign[lit_num * 2]);
+
+	for(int i = w->_occ_start[true_occ]; i < w->_occ_start[true_occ + 1]; i++)
 	{
-		// If t is true, then use the pos_lit_in array:
-		for(int i = 0; i < M; i++)
-		{
-			// If literal is in clause i
-			if(pos_lit_in[i * N + abs(lit_num)])
-			{
-				if(true_lits_in(Problem + i * K, lit_assign) == 1)
-					break_val++;
+		if(w->_true_num[w->_occ[i]] == 1)
+			break_val++;
 
-				if(break_val > min_brk)
-					return break_val;
-			}
-		}
+		if(break_val > w->_min_brk)
+			return break_val;
 	}
-	// The truth value of the literal is false:
-	else
+
+	// The opposite literal becomes true, which breaks the
+	// constraints that are at their bound
+	for(int i = w->_card_occ_start[_lit_neg(true_occ)]; i < w->_card_occ_start[_lit_neg(true_occ) + 1]; i++)
+		if(w->_card_true[w->_card_occ[i]] == w->_card_bound[w->_card_occ[i]])
+			break_val++;
+
+	return break_val;
+}
+
+// Adaptive noise mechanism, based on the paper "An Adaptive Noise
+// Mechanism for WalkSAT" by Holger H. Hoos. Called once per step.
+void adapt_noise(walk_solver *w)
+{
+	if(w->_false_num < w->_adapt_false)
 	{
-		for(int i = 0; i < M; i++)
-		{
-			if(neg_lit_in[i * N + abs(lit_num)])
-			{
-				if(true_lits_in(Problem + i * K, lit_assign) == 1)
-					break_val++;
+		w->_noise -= w->_noise * ADAPT_PHI / 2;
+		w->_adapt_false = w->_false_num;
+		w->_adapt_steps = 0;
+	}
 
-				if(break_val > min_brk)
-					return break_val;
-			}
-		}
+	else if(++w->_adapt_steps > ADAPT_THETA * w->_m)
+	{
+		w->_noise += (1 - w->_noise) * ADAPT_PHI;
+		w->_adapt_false = w->_false_num;
+		w->_adapt_steps = 0;
 	}
 
-	return break_val;
+	else
+		return;
+
+	w->_p_threshold = rng_threshold(1 - w->_noise);
 }
 
 // Randomly pick a literal. We have 2 options
 // from where to pick the literal: from the selected
-// clause or from the min_brk_lits list.
-literal pick_lit(int *clause, literal *lit_assign)
+// clause or from the min_brk_lits buffer.
+int pick_lit(walk_solver *w, int *clause, int len, unsigned char *lit_assign)
 {
-	literal lit;			// A tmp literal.
-	literal ret_lit;		// The picked literal, that will be returned.
+	int lit;				// A tmp literal.
+	int ret_lit;			// The picked literal, that will be returned.
 	int lit_brk;
-	float p;
 
-	// Initialized to M (the maximum break value)
-	min_brk = M;
+	if(w->_adaptive)
+		adapt_noise(w);
+
+	// Initialized to M (the maximum break value, with the constraints)
+	w->_min_brk = w->_m + w->_c;
 
-	// Fill the min_brk_lits list with literals
+	// Fill the min_brk_lits buffer with literals
 	// of the minimum break value, search for the minimum
 	// and calculate each literal's break value, that is in the
 	// selected clause.
-	for(int i = 0; i < K; i++)
+	for(int i = 0; i < len; i++)
 	{
-		_liti(lit) = abs(clause[i]) - 1;
-		lit_brk = break_count(clause, lit_assign, _liti(lit));
-	
-		if(lit_brk < min_brk)
+		lit = _lit_var(clause[i]);
+		lit_brk = break_count(w, lit_assign, lit);
+
+		if(lit_brk < w->_min_brk)
 		{
-			min_brk = lit_brk;
-			
-			// Reset the list, so that it contains
+			w->_min_brk = lit_brk;
+
+			// Reset the buffer, so that it contains
 			// only literals with the minimum break value
-			_reset(min_brk_lits);
-			shift(lit_assign[_liti(lit)]);
+			w->_min_brk_size = 0;
+			push_min_brk(w, lit);
 		}
 
-		else 
-			if(lit_brk == min_brk)
-				shift(lit_assign[_liti(lit)]);	// Add literals of the minimum break value
+		else
+			if(lit_brk == w->_min_brk)
+				push_min_brk(w, lit);		// Add literals of the minimum break value
 	}
 
 	// Randomly select a literal, either from a clause
-	// or from the min_brk_lits list.
-	
+	// or from the min_brk_lits buffer.
+
 	// the 0-break condition:
-	if(min_brk == 0)
-		ret_lit = select_nd(rand() % min_brk_lits->_size);
-	
+	if(w->_min_brk == 0)
+		ret_lit = select_nd(w, rng_bounded(&w->_rng, w->_min_brk_size));
+
 	else
 	{
-		// Reduce to just 3 floating point numbers:
-		p = (rand() / (float) RAND_MAX);
+		// Randomly select from min_brk_lits, with a probability of P
+		if(rng_chance(&w->_rng, w->_p_threshold))
+			ret_lit = select_nd(w, rng_bounded(&w->_rng, w->_min_brk_size));
 
-		p = roundf(p * 1000) / 1000;
-		
 		// Randomly select from clause
-		if(p >= P)
-		{
-			int lit_num = abs(clause[rand() % K]) - 1;
-			ret_lit = lit_assign[lit_num];
-		}
-
-		// Randomly select from min_brk_lits
 		else
-			if(p < P)
-				ret_lit = select_nd(rand() % min_brk_lits->_size);
+			ret_lit = _lit_var(clause[rng_bounded(&w->_rng, len)]);
 	}
 
-	_reset(min_brk_lits);
+	w->_min_brk_size = 0;
 
 	return ret_lit;
 }
 
-// Check whether the Problem is satisfied,
-// with the current truth value assignment
-int satisfiable(literal *lit_assign)
+// Check whether the problem is satisfied, with the current
+// truth value assignment. The clauses are evaluated one by one
+// (stopping at the first false one), so the check does not
+// depend on the incremental counters of the search.
+int satisfiable(walk_solver *w, unsigned char *lit_assign)
 {
-	int truth_val;
+	for(int i = 0; i < w->_m; i++)
+		if(!clause_satisfaction(w->_problem + w->_clause_start[i], w->_clause_start[i + 1] - w->_clause_start[i], lit_assign))
+			return 0;
 
-	// Check if all clauses return a truth value
-	// of true. I will use the true_lits_in function
-	for(int i = 0; i < M; i++)
-	{
-		truth_val = 0;
-		
-		if(true_lits_in(Problem + i * K, lit_assign) == 0)
-			break;
-		
-		truth_val = 1;
-	}
+	for(int i = 0; i < w->_c; i++)
+		if(true_lits_in(w->_card_lits + w->_card_start[i], w->_card_start[i + 1] - w->_card_start[i], lit_assign) > w->_card_bound[i])
+			return 0;
 
 	// If all clauses are satisfied, 1 (true) will be returned
-	return truth_val;
+	return 1;
 }
 
-// Writes the assignment of the literals, that was found
-// and can solve the problem
-void write_sol(literal *lit_assign, char *outfname)
+// Store the true literals of the unsatisfied constraint card in
+// _card_pick, for the method to pick one of them. Returns their number.
+int card_pick_lits(walk_solver *w, int card, unsigned char *lit_assign)
 {
-	FILE *outf;
-
-	outf = fopen(outfname, "w");
-
-	for(int i = 0; i < N; i++)
-	{	
-		// Parse the truth values to the output truth values
-		// (0 (false) becomes -1 and 1 (true) remains true)
-		if(_truth_val(lit_assign[i]))
-			fprintf(outf, "%d ", 1);
-		
-		else if(!_truth_val(lit_assign[i]))
-			fprintf(outf, "%d ", -1);
-	}
+	int num = 0;
+
+	for(int i = w->_card_start[card]; i < w->_card_start[card + 1]; i++)
+		if(_lit_is_true(w->_card_lits[i], lit_assign))
+			w->_card_pick[num++] = w->_card_lits[i];
+
+	return num;
 }
 
 // Displays the solution literal assignment found
-void display(literal *lit_assign)
+void display(int *model, int n)
 {
-	for(int i = 0; i < N; i++)
+	for(int i = 0; i < n; i++)
 	{
-		if(_truth_val(lit_assign[i]))
+		if(model[i] == 1)
 			printf("P%d=%s ", i, "true");
-		
-		else if(!_truth_val(lit_assign[i]))
+
+		else
 			printf("P%d=%s", i, "false");
 	}
 }
 
-// Check if a clause has a truth value of true or false.
-// The method returns this truth value. (the clause is 
-// a disjunctive clause)
-int clause_satisfaction(int *clause, literal *lit_assign)
+// Randomly generate an assgnment for all literals
+void random_assignment(walk_solver *w, unsigned char *lit_assign)
 {
-	int truth_val = 0;
+	for(int i = 0; i < w->_n; i++)
+	{
+		lit_assign[i * 2] = rng_next(&w->_rng) >> 63;
+		lit_assign[i * 2 + 1] = !lit_assign[i * 2];
+	}
+}
+
+// Evaluate _screen random assignments, SLICE_LANES at a time,
+// and start from the one with the fewest unsatisfied clauses
+void screened_assignment(walk_solver *w, unsigned char *lit_assign)
+{
+	int best = w->_m + 1;
+
+	for(long done = 0; done < w->_screen; done += SLICE_LANES)
+	{
+		int best_lane = -1;
 
-	for(int i = 0; i < K; i++)
-		if(_neg_pos_truth_istrue(clause[i], lit_assign))
+		slice_random(w->_slices, w->_n, &w->_rng);
+		slice_count(w->_problem, w->_clause_start, w->_m, w->_slices, w->_slice_counts, w->_count_planes);
+
+		for(int lane = 0; lane < SLICE_LANES && done + lane < w->_screen; lane++)
 		{
-			truth_val = 1;
-			break;
+			int unsat = slice_lane_count(w->_slice_counts, w->_count_planes, lane);
+
+			if(unsat < best)
+			{
+				best = unsat;
+				best_lane = lane;
+			}
 		}
 
-	return truth_val;
+		if(best_lane >= 0)
+			slice_get_lane(w->_slices, w->_n, best_lane, lit_assign);
+	}
 }
 
-// The main body of the WalkSAT algorrithm
-void walksat(char *outfname)
+/*
+	A local search method that uses the search loop below. _pick picks the
+	literal to flip, given a randomly selected unsatisfied clause and its
+	length (pick_lit
+	for WalkSAT), or the true literals of an unsatisfied cardinality
+	constraint. Methods that keep more information about the assignment
+	can also set _start, which is called at the beginning of each try (after
+	the counters are initialized), and _flipped, called after each flip.
+	The name of the method is only used for printing.
+*/
+typedef struct local_method
 {
-	int max_steps = 20000;		// I found on the internet that 100000 was used.
-								// I will use 20000, because the execution time is
-								// close with the time limit, of the other 2 algorithms.
-	
-	int clause_num;
-	int found = 0;
-	int steps = 0;
-	literal lit_assign[N];
-	literal lit;
-	clock_t t1, t2;
+	char *_name;
+	int (*_pick)(walk_solver *w, int *clause, int len, unsigned char *lit_assign);
+	void (*_start)(walk_solver *w, unsigned char *lit_assign);
+	void (*_flipped)(walk_solver *w, int lit_num, unsigned char *lit_assign);
+} local_method;
+
+/*
+	The checkpoint of a search, taken between two steps, is everything the
+	next steps depend on: the state of the generator, the try and its step,
+	the noise, the assignment and the order of the unsatisfied clauses
+	(which the next clause is picked from), as well as the best assignment
+	so far. A resumed search makes the same steps as the search would have
+	made without stopping. The counters of the clauses are computed again.
+	The methods with more state (cwls) write no checkpoints.
+
+	Checkpoint: the seed and the generator (5 uint64_t), the try (int), the
+	steps of the current and of the previous tries (2 long), the noise
+	(double, int, long and uint32_t, see adapt_noise), the unsatisfied
+	clauses of the best assignment (int), the assignment and the best one
+	(N bits each) and the unsatisfied clauses (their number and then
+	their numbers, as ints).
+*/
 
-	srand((unsigned) time(NULL));
+// Write the checkpoint of the search of the method name, at the given
+// step of the current try
+void walk_save(walk_solver *w, char *name, long steps)
+{
+	checkpoint *ck = w->_checkpoint;
+
+	checkpoint_begin(ck, name);
+	checkpoint_put(ck, &w->_seed, sizeof(uint64_t));
+	checkpoint_put(ck, w->_rng._s, 4 * sizeof(uint64_t));
+	checkpoint_put(ck, &w->_tries, sizeof(int));
+	checkpoint_put(ck, &steps, sizeof(long));
+	checkpoint_put(ck, &w->_steps, sizeof(long));
+	checkpoint_put(ck, &w->_noise, sizeof(double));
+	checkpoint_put(ck, &w->_adapt_false, sizeof(int));
+	checkpoint_put(ck, &w->_adapt_steps, sizeof(long));
+	checkpoint_put(ck, &w->_p_threshold, sizeof(uint32_t));
+	checkpoint_put(ck, &w->_best_false, sizeof(int));
+	checkpoint_put_bits(ck, w->_assignment, w->_n, 2);
+	checkpoint_put_bits(ck, w->_best_assign, w->_n, 2);
+	checkpoint_put(ck, &w->_false_num, sizeof(int));
+	checkpoint_put(ck, w->_false_clauses, w->_false_num * sizeof(int));
+	checkpoint_write(ck);
+}
 
-	t1 = clock();
+// Continue the search of the method name from its checkpoint, setting
+// *steps to the step of the current try. Returns 1 if the checkpoint was
+// read, 0 if the search starts from the beginning.
+int walk_load(walk_solver *w, char *name, long *steps)
+{
+	checkpoint *ck = w->_checkpoint;
+	uint64_t seed, state[4];
+	int tries, adapt_false, best_false, false_num = -1;
+	long try_steps, total_steps, adapt_steps;
+	double noise;
+	uint32_t p_threshold;
+	int *false_clauses = NULL;
+	int ok;
+
+	if(!checkpoint_read(ck, name, 0))
+		return 0;
+
+	ok = (checkpoint_get(ck, &seed, sizeof(uint64_t)) == 0 && checkpoint_get(ck, state, 4 * sizeof(uint64_t)) == 0 &&
+		  checkpoint_get(ck, &tries, sizeof(int)) == 0 && checkpoint_get(ck, &try_steps, sizeof(long)) == 0 &&
+		  checkpoint_get(ck, &total_steps, sizeof(long)) == 0 && checkpoint_get(ck, &noise, sizeof(double)) == 0 &&
+		  checkpoint_get(ck, &adapt_false, sizeof(int)) == 0 && checkpoint_get(ck, &adapt_steps, sizeof(long)) == 0 &&
+		  checkpoint_get(ck, &p_threshold, sizeof(uint32_t)) == 0 && checkpoint_get(ck, &best_false, sizeof(int)) == 0 &&
+		  checkpoint_get_bits(ck, w->_assignment, w->_n, 2) == 0 && checkpoint_get_bits(ck, w->_best_assign, w->_n, 2) == 0 &&
+		  checkpoint_get(ck, &false_num, sizeof(int)) == 0);
+
+	// The unsatisfied clauses must be the ones of the assignment
+	if(ok)
+	{
+		init_counters(w, w->_assignment);
+		ok = (false_num == w->_false_num);
+	}
 
-	// Randomly generate an assgnment for all literals
-	for(int i = 0; i < N; i++)
+	if(ok)
 	{
-		_truth_val(lit_assign[i]) = rand() % 2;
-		_liti(lit_assign[i]) = i;
+		false_clauses = (int *) malloc((false_num + 1) * sizeof(int));
+		ok = (checkpoint_get(ck, false_clauses, false_num * sizeof(int)) == 0 && checkpoint_done(ck));
+
+		for(int i = 0; i < false_num && ok; i++)
+			ok = (false_clauses[i] >= 0 && false_clauses[i] < w->_m + w->_c && w->_false_pos[false_clauses[i]] < false_num &&
+				  w->_false_clauses[w->_false_pos[false_clauses[i]]] == false_clauses[i]);
 	}
 
-	// Find solution, or terminate, after max_steps tries.
-	for(; steps < max_steps; steps++)
+	checkpoint_free(ck);
+
+	if(!ok)
+	{
+		printf("The checkpoint in %s is damaged, the search starts from the beginning\n", ck->_file);
+		free(false_clauses);
+		return 0;
+	}
+
+	memcpy(w->_false_clauses, false_clauses, false_num * sizeof(int));
+
+	for(int i = 0; i < false_num; i++)
+		w->_false_pos[false_clauses[i]] = i;
+
+	w->_seed = seed;
+	memcpy(w->_rng._s, state, 4 * sizeof(uint64_t));
+	w->_tries = tries;
+	w->_steps = total_steps;
+	w->_noise = noise;
+	w->_adapt_false = adapt_false;
+	w->_adapt_steps = adapt_steps;
+	w->_p_threshold = p_threshold;
+	w->_best_false = best_false;
+	*steps = try_steps;
+
+	printf("Resuming %s from the checkpoint %s (try %d, step %ld)\n", name, ck->_file, tries + 1, try_steps);
+	free(false_clauses);
+
+	return 1;
+}
+
+// The search loop shared by the local search methods, without any
+// output. The best assignment is left in _best_assign and the number
+// of tries and of steps (of all the tries) in _tries and _steps.
+enum walk_result walk_solve(walk_solver *w, local_method method)
+{
+	int clause_num;
+	long steps = 0;			// Steps of the current try
+	enum walk_result result = WALK_STEP_LIMIT;
+	double deadline = 0;
+	double save_at = 0;		// When the next checkpoint is written (0 for none)
+	unsigned char *lit_assign = w->_assignment;
+	int lit;
+	int resumed;
+
+	rng_seed(&w->_rng, w->_seed);
+
+	if(w->_time_limit > 0)
+		deadline = wall_time() + w->_time_limit;
+
+	w->_best_false = w->_m + w->_c + 1;
+	w->_tries = 0;
+	w->_steps = 0;
+
+	if(w->_checkpoint != NULL)
+		save_at = wall_time() + w->_checkpoint->_every;
+
+	// The first try of a resumed search goes on from the checkpoint
+	resumed = (w->_checkpoint != NULL && w->_checkpoint->_resume && walk_load(w, method._name, &steps));
+
+	// Each try starts from a new random assignment
+	for(; w->_tries < w->_max_tries && result == WALK_STEP_LIMIT; w->_tries++)
 	{
-		// WalkSAT found a solution
-		if(satisfiable(lit_assign))
+		if(!resumed)
 		{
-			write_sol(lit_assign, outfname);
-			found = 1;
-			
-			break;
+			if(w->_screen > 0)
+				screened_assignment(w, lit_assign);
+			else
+				random_assignment(w, lit_assign);
+
+			init_counters(w, lit_assign);
+			steps = 0;
 		}
 
-		// No solution, so randomly choose a literal from
-		// a non satisfied clause.
-		do
+		if(method._start != NULL)
+			method._start(w, lit_assign);
+		w->_flipped_num = w->_n + 1;
+		resumed = 0;
+
+		// Find solution, or terminate, after max_flips steps.
+		for(; ; steps++)
 		{
-			clause_num = rand() % M;
-		} while(clause_satisfaction(Problem + clause_num * K, lit_assign));
-		// The above while checks if the randomly chosen clause is satisfied
-		// by the assignment or not.
-
-		// Flip the randomly selected, from the randomly slectd clause, 
-		// literal's truth value
-		lit = pick_lit(Problem + clause_num * K, lit_assign);
-		_flip_truth_val(lit_assign[_liti(lit)]);
+			// Keep the assignment with the fewest unsatisfied clauses
+			if(w->_false_num < w->_best_false)
+				save_best(w, lit_assign);
+
+			// WalkSAT found a solution
+			if(w->_false_num == 0)
+			{
+				result = WALK_SOLVED;
+				break;
+			}
+
+			if(steps == w->_max_flips)
+				break;
+
+			if(interrupted)
+			{
+				result = WALK_INTERRUPTED;
+				break;
+			}
+
+			// Reading the clock is expensive compared to a step, so the
+			// time limit (and the time of the checkpoint) is only checked
+			// periodically
+			if((deadline > 0 || save_at > 0) && (steps & TIME_CHECK_MASK) == 0)
+			{
+				double now = wall_time();
+
+				if(deadline > 0 && now >= deadline)
+				{
+					result = WALK_TIMEOUT;
+					break;
+				}
+
+				if(save_at > 0 && now >= save_at)
+				{
+					walk_save(w, method._name, steps);
+					save_at = now + w->_checkpoint->_every;
+				}
+			}
+
+			// No solution, so randomly choose a literal from
+			// a non satisfied clause.
+			clause_num = w->_false_clauses[rng_bounded(&w->_rng, w->_false_num)];
+
+			// Flip the randomly selected, from the randomly slectd clause,
+			// literal's truth value
+			if(clause_num < w->_m)
+				lit = method._pick(w, _clause_of(w, clause_num), _len_of(w, clause_num), lit_assign);
+			else
+				lit = method._pick(w, w->_card_pick, card_pick_lits(w, clause_num - w->_m, lit_assign), lit_assign);
+
+			flip(w, lit, lit_assign);
+
+			if(method._flipped != NULL)
+				method._flipped(w, lit, lit_assign);
+		}
+
+		// A stopped search can be resumed from where it stopped
+		if(w->_checkpoint != NULL && (result == WALK_TIMEOUT || result == WALK_INTERRUPTED))
+			walk_save(w, method._name, steps);
+
+		w->_steps += steps;
 	}
 
+	// The checkpoint of a search that is over is of no use
+	if(w->_checkpoint != NULL && (result == WALK_SOLVED || result == WALK_STEP_LIMIT))
+		checkpoint_remove(w->_checkpoint);
+
+	return result;
+}
+
+// Run the search of a method on the problem pb and print its outcome
+void local_search(walk_solver *w, problem *pb, local_method method, char *outfname)
+{
+	enum walk_result result;
+	int *model = (int *) malloc(w->_n * sizeof(int));
+	int verified;
+	clock_t t1, t2;
+
+	t1 = clock();
+	result = walk_solve(w, method);
 	t2 = clock();
 
-	if(found)
+	// The truth values are parsed to the output truth values
+	// (0 (false) becomes -1 and 1 (true) remains 1), and the
+	// symbols removed by the preprocessing are set
+	for(int i = 0; i < w->_n; i++)
+		model[i] = ((w->_best_assign[i * 2]) ? (1) : (-1));
+
+	verified = finish_model(pb, model);
+
+	// Also the near-solution is written, when no solution was found
+	write_model(model, w->_n, outfname, pb->_number);
+
+	if(result == WALK_SOLVED)
 	{
-		printf("\n\nSolution found with WalkSAT!\n"); display(lit_assign); printf("\n");
-		printf("Time spent: %f secs\n",((float) t2-t1)/CLOCKS_PER_SEC);
-		printf("Number of steps: %d\n",steps);
+		printf("\n\nSolution found with %s!\n", method._name); display(model, w->_n); printf("\n");
+		printf("Solution verified: %s\n", ((verified) ? ("yes") : ("NO")));
 	}
 
 	else
 	{
-		printf("\n\nNO SOLUTION found with WalkSAT...\n");
-		printf("Time spent: %f secs\n",((float) t2-t1)/CLOCKS_PER_SEC);
-		printf("Number of steps: %d\n",steps);
+		printf("\n\nNO SOLUTION found with %s...\n", method._name);
+		printf("Unsatisfied clauses%s of the best assignment: %d\n", ((w->_c > 0) ? (" and constraints") : ("")), w->_best_false);
 	}
-}
 
-// The readfile from bcsp.c, but modified, for
-// the needs of the walksat algorithm.
-int walk_init(char *filename) {
-	int i,j;
-
-	FILE *infile;
-	int err;
-	
-	// Opening the input file
-	infile=fopen(filename,"r");
-	if (infile==NULL) {
-		printf("Cannot open input file. Now exiting...\n");
-		fclose(infile);
-		return -1;
-	}
+	printf("Result: %s\n", walk_result_name[result]);
+	printf("Time spent: %f secs\n",((float) t2-t1)/CLOCKS_PER_SEC);
+	printf("Number of tries: %d\n", w->_tries);
+	printf("Number of steps: %ld\n", w->_steps);
+	printf("Seed: %llu\n", (unsigned long long) w->_seed);
 
-	// Reading the number of propositions
-	err=fscanf(infile, "%d", &N);
-	if (err<1) {
-		printf("Cannot read the number of propositions. Now exiting...\n");
-		fclose(infile);
-		return -1;
-	}
+	if(w->_screen > 0)
+		printf("Screened starts: %ld per try (%s kernel)\n", w->_screen, slice_kernel_name);
 
-	if (N<1) {
-		printf("Small number of propositions. Now exiting...\n");
-		fclose(infile);
-		return -1;
-	}
+	free(model);
+}
 
-	// Reading the number of sentences
-	err=fscanf(infile, "%d", &M);
-	if (err<1) {
-		printf("Cannot read the number of sentences. Now exiting...\n");
-		fclose(infile);
-		return -1;
-	}
+// Set the noise of WalkSAT, fixed or adaptive
+void walk_noise_init(walk_solver *w)
+{
+	w->_p_threshold = rng_threshold(P);
 
-	if (M<1) {
-		printf("Low number of sentences. Now exiting...\n");
-		fclose(infile);
-		return -1;
+	if(w->_adaptive)
+	{
+		w->_noise = 0;
+		w->_adapt_false = w->_m + w->_c + 1;
+		w->_adapt_steps = 0;
+		w->_p_threshold = rng_threshold(1 - w->_noise);
 	}
+}
 
-	// Reading the number of propositions per sentence
-	err=fscanf(infile, "%d", &K);
-	if (err<1) {
-		printf("Cannot read the number of propositions per sentence. Now exiting...\n");
-		fclose(infile);
-		return -1;
-	}
+// The main body of the WalkSAT algorrithm
+void walksat(walk_solver *w, problem *pb, char *outfname)
+{
+	walk_noise_init(w);
+	local_search(w, pb, (local_method) {"WalkSAT", pick_lit, NULL, NULL}, outfname);
 
-	if (K<2) {
-		printf("Low number of propositions per sentence. Now exiting...\n");
-		fclose(infile);
-		return -1;
-	}
+	if(w->_adaptive)
+		printf("Final noise: %f\n", w->_noise);
+}
 
-	// Allocating memory for the sentences...
-	Problem=(int*) malloc(M*K*sizeof(int));
-	pos_lit_in = (int *) malloc(M * N * sizeof(int));
-	neg_lit_in = (int *) malloc(M * N * sizeof(int));
-
-	// ...and read them
-	for (i=0;i<M;i++)
-		for(j=0;j<K;j++) {
-			err=fscanf(infile,"%d", Problem+i*K+j);
-			if (err<1) {
-				printf("Cannot read the #%d proposition of the #%d sentence. Now exiting...\n",j+1,i+1);
-				fclose(infile);
-				return -1;
-			}
-			if (Problem[i*K+j]==0 || Problem[i*K+j]>N || Problem[i*K+j]<-N) {
-				printf("Wrong value for the #%d proposition of the #%d sentence. Now exiting...\n",j+1,i+1);
-				fclose(infile);
-				return -1;
-			}
+// Set the parameters of the search to their defaults
+void walk_defaults(walk_solver *w)
+{
+	memset(w, 0, sizeof(walk_solver));
+	w->_seed = rng_default_seed();
+	w->_max_flips = 20000;		// I found on the internet that 100000 was used.
+								// I use 20000 as default, because the execution time is
+								// close with the time limit, of the other 2 algorithms.
+	w->_max_tries = 1;
+}
 
-			// walk_init pos_lit_in and neg_lit_in:
-			if(Problem[i * K + j] > 0)
-				pos_lit_in[i * N + Problem[i * K + j] - 1] = 1;
-			
-			else if(Problem[i * K + j] < 0)
-				neg_lit_in[i * N + (abs(Problem[i * K + j]) - 1)] = 1;
-		}
-	
-	fclose(infile);
+// Build the occurrence lists and the buffers of the search for the
+// problem f, which must stay allocated while the solver is used
+void walk_create(walk_solver *w, cnf *f) {
+	int i;
+
+	w->_n = f->_n;
+	w->_m = f->_m;
+	w->_k = f->_k;
+	w->_problem = f->_lits;
+	w->_clause_start = f->_start;
+	w->_c = f->_c;
+	w->_card_lits = f->_card_lits;
+	w->_card_start = f->_card_start;
+	w->_card_bound = f->_card_bound;
+
+	// The literals of a constraint are picked from like the ones of a clause
+	for(i = 0; i < w->_c; i++)
+		if(_card_len(f, i) > w->_k)
+			w->_k = _card_len(f, i);
+
+	w->_occ_start = (int *) calloc(2 * w->_n + 1, sizeof(int));
+	w->_occ = (int *) malloc((w->_clause_start[w->_m] + 1) * sizeof(int));
+
+	// ...and the working buffers of the search
+	w->_min_brk_lits = (int *) malloc(w->_k * sizeof(int));
+	w->_min_brk_size = 0;
+	w->_assignment = (unsigned char *) malloc(2 * w->_n * sizeof(unsigned char));
+	w->_best_assign = (unsigned char *) malloc(2 * w->_n * sizeof(unsigned char));
+	w->_flipped = (int *) malloc(w->_n * sizeof(int));
+	w->_true_num = (int *) malloc((w->_m + 1) * sizeof(int));
+	w->_false_clauses = (int *) malloc((w->_m + w->_c + 1) * sizeof(int));
+	w->_false_pos = (int *) malloc((w->_m + w->_c + 1) * sizeof(int));
+	w->_card_true = (int *) malloc((w->_c + 1) * sizeof(int));
+	w->_card_occ_start = (int *) calloc(2 * w->_n + 1, sizeof(int));
+	w->_card_occ = (int *) malloc((_card_total(f) + 1) * sizeof(int));
+	w->_card_pick = (int *) malloc((w->_k + 1) * sizeof(int));
+
+	// Count the occurrences of each literal
+	for(i = 0; i < w->_clause_start[w->_m]; i++)
+		w->_occ_start[w->_problem[i] + 1]++;
+
+	// Fill the occurrence lists. _occ_start is first moved one position
+	// ahead, so that it can be used as the insertion point of each list.
+	for(i = 0; i < 2 * w->_n; i++)
+		w->_occ_start[i + 1] += w->_occ_start[i];
+
+	for(i = 2 * w->_n; i > 0; i--)
+		w->_occ_start[i] = w->_occ_start[i - 1];
+
+	for(i = 0; i < w->_m; i++)
+		for(int j = w->_clause_start[i]; j < w->_clause_start[i + 1]; j++)
+			w->_occ[w->_occ_start[w->_problem[j] + 1]++] = i;
+
+	// The same for the constraints
+	for(i = 0; i < _card_total(f); i++)
+		w->_card_occ_start[w->_card_lits[i] + 1]++;
+
+	for(i = 0; i < 2 * w->_n; i++)
+		w->_card_occ_start[i + 1] += w->_card_occ_start[i];
+
+	for(i = 2 * w->_n; i > 0; i--)
+		w->_card_occ_start[i] = w->_card_occ_start[i - 1];
+
+	for(i = 0; i < w->_c; i++)
+		for(int j = w->_card_start[i]; j < w->_card_start[i + 1]; j++)
+			w->_card_occ[w->_card_occ_start[w->_card_lits[j] + 1]++] = i;
+
+	// The slices take 64 bytes for each literal, so they are only
+	// made for the screening
+	w->_slices = NULL;
+	w->_slice_counts = NULL;
+
+	if(w->_screen > 0)
+	{
+		w->_count_planes = slice_planes(w->_m);
+		w->_slices = (uint64_t *) malloc(2 * w->_n * SLICE_WORDS * sizeof(uint64_t));
+		w->_slice_counts = (uint64_t *) malloc(w->_count_planes * SLICE_WORDS * sizeof(uint64_t));
+		slice_select();
+	}
+}
 
-	return 0;
-}
\ No newline at end of file
+// Free the buffers of walk_create (but not the problem itself)
+void walk_destroy(walk_solver *w)
+{
+	free(w->_occ_start); free(w->_occ);
+	free(w->_min_brk_lits); free(w->_assignment); free(w->_best_assign); free(w->_flipped);
+	free(w->_true_num); free(w->_false_clauses); free(w->_false_pos);
+	free(w->_card_true); free(w->_card_occ_start); free(w->_card_occ); free(w->_card_pick);
+	free(w->_slices); free(w->_slice_counts);
+}
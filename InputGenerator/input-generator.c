@@ -5,122 +5,832 @@
 
     Note: I created this file, because I did not want to upload
           the exercise's given file generator.
+
+    The clauses are never stored as a whole problem. They are generated in
+    chunks of about CHUNK_BYTES of text, straight into the text that is
+    written, so the size of a problem is limited only by the disk. Each
+    chunk has its own random number generator, seeded by the seed, the
+    problem and the chunk, so the chunks are generated in parallel, by
+    --threads threads, and the same seed always generates the same problems,
+    with any number of threads. While the threads generate the next chunks,
+    the main thread writes the previous ones, in order.
+
+    Besides random K-SAT (--family random), whose problems may or may not
+    have a solution, the generator makes families of problems whose answer
+    is known, written next to each problem for the benchmarks:
+    - planted: random K-SAT satisfied by a hidden assignment, which is
+      found from the seed and the symbol alone (see hidden_bits), so the
+      chunks need not share it. Its literals are balanced, see planted_clause.
+    - pigeonhole: N + 1 pigeons in N holes, which has no solution.
+    - coloring: K colours for a random graph, with edges only between
+      vertices of different colours in a hidden colouring.
+    - parity: chains of XOR constraints over the symbols, with the parity of
+      each chain taken from a hidden assignment.
+    The clauses of the last three are not all of length K, so they are
+    written in DIMACS, which the solver also reads.
+
+    Link used:
+    https://arxiv.org/abs/cs/0503044
 */
 
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
 #include <math.h>
+#include <unistd.h>
+#include "../Algorithms/rng.h"
 
 #define PREFIX_SIZE 20
+#define CHUNK_BYTES (1 << 20)   // The text of a chunk of clauses is about this long
+#define HIDDEN_MIX (1ULL << 63) // Mixed in the seeds of the hidden assignments
+#define CHAIN_MIX (1ULL << 62)  // Mixed in the seeds of the parity chains
+
+// The families of problems that can be generated
+enum family
+{
+    RANDOM,         // Random K-SAT
+    PLANTED,        // Random K-SAT, satisfied by a hidden assignment
+    PIGEONHOLE,     // N + 1 pigeons in N holes
+    COLORING,       // K colours for a random graph of N vertices and M edges
+    PARITY          // M parity (XOR) chains of K of the N symbols
+};
+
+char *family_name[] = {"random", "planted", "pigeonhole", "coloring", "parity"};
 
 long M;
 long N;
 long K;
+enum family FAMILY = RANDOM;
+
+// The clauses of a chunk of a problem, generated by a thread
+typedef struct chunk
+{
+    int _problem;       // The problem (file) of the chunk
+    long _index;        // The chunk of the problem (0 for the first)
+    long _first;        // Its first unit (see problem_units)
+    long _num;          // Its number of units
+    uint64_t _seed;     // The seed of all the problems
+
+    char *_buf;         // The text of the chunk
+    long _len;
+    long _cap;
+    int _width;         // The characters of the longest literal
+    long *_lits;        // The literals of the current clause
+    long *_hash;        // The symbols of the current clause, see random_clause
+    long _hash_size;
+} chunk;
 
 void syntax_message()
 {
     printf("Wrong number of arguments\n");
     printf("Correct syntax is the following:\n");
-    printf("./<binary-name> <M> <N> <K> <number-of-problems-to-generate> <file-name>\n");
+    printf("./<binary-name> <M> <N> <K> <number-of-problems-to-generate> <file-name> [--seed <number>] [--threads <number>]\n");
+    printf("                [--family random|planted|pigeonhole|coloring|parity] [--answers <file>]\n");
     printf("File naming is <file-name>_x.txt, where x represnts a number, starting from 1\n");
+    printf("If <file-name> is -, all the problems are written to the standard output, one after the other\n");
     printf("The <number-of-problems-to-generate>, must be a positive number\n");
+    printf("The same --seed always generates the same problems\n");
+    printf("--threads sets the threads generating the problems (default the number of CPUs)\n");
+    printf("--family sets the family of the problems (default random):\n");
+    printf("    random:     M random clauses of K of the N symbols\n");
+    printf("    planted:    as random, all satisfied by a hidden assignment (K at least 2)\n");
+    printf("    pigeonhole: N + 1 pigeons in N holes, never satisfiable (M and K are not used)\n");
+    printf("    coloring:   K colours for a random graph of N vertices and M edges, with a hidden colouring\n");
+    printf("    parity:     M parity chains of K of the N symbols (K at least 2), with a hidden assignment\n");
+    printf("The known answer of each problem is written to <file-name>_x.ans, or to the --answers file\n");
     printf("Note: N must be equal or bigger than K.");
 }
 
-// Checks if the random generator, has already created
-// this value.
-int same_val(int genum, int problem[M][K], int clause_num, int litlim)
+// The symbols of a problem of the family
+long problem_symbols(void)
 {
-    for(int j = 0; j < litlim; j++)
-        if(abs(problem[clause_num][j]) == genum)
-            return 1;
+    switch(FAMILY)
+    {
+        case PIGEONHOLE: return N * (N + 1);
+        case COLORING: return N * K;
+        case PARITY: return N + M * (K - 1);
+        default: return N;
+    }
+}
 
-    return 0;
+// The clauses of a problem of the family
+long problem_clauses(void)
+{
+    switch(FAMILY)
+    {
+        case PIGEONHOLE: return (N + 1) + N * (N * (N + 1) / 2);
+        case COLORING: return N * (1 + K * (K - 1) / 2) + M * K;
+        case PARITY: return M * (4 * (K - 1) + 1);
+        default: return M;
+    }
+}
+
+// A problem is generated in units, each one generated at once: a clause
+// of the random families, a pigeon or a hole, a vertex or an edge, or a
+// parity chain
+long problem_units(void)
+{
+    switch(FAMILY)
+    {
+        case PIGEONHOLE: return 2 * N + 1;
+        case COLORING: return N + M;
+        default: return M;
+    }
+}
+
+// The most literals of the clauses of a unit
+long unit_literals(void)
+{
+    switch(FAMILY)
+    {
+        case PIGEONHOLE: return N * (N + 1);
+        case COLORING: return K * K;
+        case PARITY: return 12 * (K - 1) + 1;
+        default: return K;
+    }
+}
+
+// Write the integer x at the end of the text of the chunk,
+// with its digits found from the last one
+void put_int(chunk *c, long x)
+{
+    char digits[24];
+    int num = 0;
+    unsigned long u = ((x < 0) ? (-(unsigned long) x) : ((unsigned long) x));
+
+    if(x < 0)
+        c->_buf[c->_len++] = '-';
+
+    do
+    {
+        digits[num++] = '0' + u % 10;
+        u /= 10;
+    } while(u);
+
+    while(num)
+        c->_buf[c->_len++] = digits[--num];
+}
+
+// The number of characters of the longest literal (-N and a space)
+int literal_width(void)
+{
+    int width = 2;
+
+    for(long n = problem_symbols(); n > 0; n /= 10)
+        width++;
+
+    return width;
+}
+
+// Make room for bytes more characters in the text of the chunk
+void reserve(chunk *c, long bytes)
+{
+    if(c->_len + bytes <= c->_cap)
+        return;
+
+    c->_cap = 2 * (c->_len + bytes);
+    c->_buf = (char *) realloc(c->_buf, c->_cap);
+}
+
+// Write a clause of len literals: as a line of the <N> <M> <K> format for
+// the random families, or in DIMACS (ending with a 0) for the structured
+// ones, as their clauses are not all of the same length
+void put_clause(chunk *c, long *lits, long len)
+{
+    int dimacs = (FAMILY != RANDOM && FAMILY != PLANTED);
+
+    reserve(c, (len + 1) * c->_width + 2);
+
+    for(long j = 0; j < len; j++)
+    {
+        put_int(c, lits[j]);
+        c->_buf[c->_len++] = ' ';
+    }
+
+    if(dimacs)
+        c->_buf[c->_len++] = '0';
+    else
+        c->_len--;
+
+    c->_buf[c->_len++] = '\n';
+}
+
+// The hidden bits of the symbol (or vertex) x of a problem. They are
+// found from the seed, the problem and x alone, so all the chunks (and the
+// answer) see the same hidden assignment, without keeping it in memory.
+uint64_t hidden_bits(uint64_t seed, int problem, long x)
+{
+    uint64_t mix = ((uint64_t) problem << 40) ^ (uint64_t) x ^ HIDDEN_MIX;
+    uint64_t z = seed ^ splitmix64(&mix);
+
+    return splitmix64(&z);
+}
+
+// The truth value (0 or 1) of the symbol x in the hidden assignment
+int hidden_value(chunk *c, long x)
+{
+    return hidden_bits(c->_seed, c->_problem, x) >> 63;
+}
+
+// The colour of the vertex v (from 0) in the hidden colouring
+long hidden_colour(chunk *c, long v)
+{
+    return hidden_bits(c->_seed, c->_problem, v + 1) % K;
+}
+
+// Add the symbol genum to the symbols of the clause. Returns 0 if it
+// is already one of them.
+int add_symbol(chunk *c, long genum)
+{
+    long h = (long) ((genum * 0x9e3779b97f4a7c15ULL) >> 32) & (c->_hash_size - 1);
+
+    while(c->_hash[h] != 0)
+    {
+        if(c->_hash[h] == genum)
+            return 0;
+
+        h = (h + 1) & (c->_hash_size - 1);
+    }
+
+    c->_hash[h] = genum;
+
+    return 1;
 }
 
-// Create a random problem
-void random_problem(int problem[M][K])
+// Create a random clause in _lits. The symbols of the clause are kept in
+// a hash table, at least twice as large as K, so a repeated symbol is found
+// in constant time (instead of comparing it with all the previous ones).
+void random_clause(chunk *c, rng *r)
 {
-    for(int i = 0; i < M; i++)
+    memset(c->_hash, 0, c->_hash_size * sizeof(long));
+
+    for(int j = 0; j < K; j++)
     {
-        int genum;
+        long genum;
+
+        do
+        {
+            genum = rng_bounded(r, N) + 1; // Exclude 0 and reach to N
+        } while(!add_symbol(c, genum));
+
+        // Randomly select if it will be a negative or positive literal
+        int p = rng_next(r) >> 63;
+
+        c->_lits[j] = ((p) ? (-genum) : (genum));
+    }
+}
+
+// Create a random clause satisfied by the hidden assignment. Only the
+// clauses with both true and false literals in it are kept, so the
+// opposite assignment satisfies them too, and each literal agrees with the
+// hidden assignment as often as it disagrees. Otherwise (keeping all the
+// clauses with a true literal) the signs of the literals of each symbol
+// would mostly agree with it, and give it away.
+void planted_clause(chunk *c, rng *r)
+{
+    int t;
+
+    random_clause(c, r);
+
+    for(;;)
+    {
+        t = 0;
+
+        for(int j = 0; j < K; j++)
+            t += ((c->_lits[j] > 0) == hidden_value(c, labs(c->_lits[j])));
+
+        if(t > 0 && t < K)
+            break;
 
         for(int j = 0; j < K; j++)
+            c->_lits[j] = ((rng_next(r) >> 63) ? (-labs(c->_lits[j])) : (labs(c->_lits[j])));
+    }
+}
+
+// The symbol of pigeon i in hole j
+#define _pigeon(i, j) ((i) * N + (j) + 1)
+
+// Pigeon u is in some hole, and (for u > N) hole u - N - 1 has at most one pigeon
+void pigeonhole_unit(chunk *c, long u)
+{
+    if(u <= N)
+    {
+        for(long j = 0; j < N; j++)
+            c->_lits[j] = _pigeon(u, j);
+
+        put_clause(c, c->_lits, N);
+        return;
+    }
+
+    for(long i = 0; i <= N; i++)
+        for(long k = i + 1; k <= N; k++)
         {
-            do
+            long pair[2] = {-_pigeon(i, u - N - 1), -_pigeon(k, u - N - 1)};
+
+            put_clause(c, pair, 2);
+        }
+}
+
+// The symbol of vertex v having colour col
+#define _colour(v, col) ((v) * K + (col) + 1)
+
+// Vertex u (for u < N) has exactly one colour, or a random edge (for the
+// rest) has different colours at its ends. The edges only join vertices of
+// different hidden colours, so the hidden colouring is a solution.
+void coloring_unit(chunk *c, long u, rng *r)
+{
+    if(u < N)
+    {
+        for(long col = 0; col < K; col++)
+            c->_lits[col] = _colour(u, col);
+
+        put_clause(c, c->_lits, K);
+
+        for(long col = 0; col < K; col++)
+            for(long other = col + 1; other < K; other++)
             {
-                genum = rand() % N + 1; // Exclude 0 and reach to N
-            } while(same_val(genum, problem, i, j));
+                long pair[2] = {-_colour(u, col), -_colour(u, other)};
+
+                put_clause(c, pair, 2);
+            }
+
+        return;
+    }
+
+    long a, b;
+
+    do
+    {
+        a = rng_bounded(r, N);
+        b = rng_bounded(r, N);
+    } while(hidden_colour(c, a) == hidden_colour(c, b));
+
+    for(long col = 0; col < K; col++)
+    {
+        long pair[2] = {-_colour(a, col), -_colour(b, col)};
+
+        put_clause(c, pair, 2);
+    }
+}
+
+// The K symbols of a parity chain in _lits, from its own random number
+// generator, so the answer finds them again. Returns the parity of their
+// hidden values.
+int chain_symbols(chunk *c, long chain)
+{
+    uint64_t mix = ((uint64_t) c->_problem << 40) ^ (uint64_t) chain ^ CHAIN_MIX;
+    int parity = 0;
+    rng r;
+
+    rng_seed(&r, c->_seed ^ splitmix64(&mix));
+    memset(c->_hash, 0, c->_hash_size * sizeof(long));
 
-            // Randomly select if it will be a negative or positive literal
-            int p = rand() % 10;
+    for(int j = 0; j < K; j++)
+    {
+        long genum;
+
+        do
+        {
+            genum = rng_bounded(&r, N) + 1;
+        } while(!add_symbol(c, genum));
+
+        c->_lits[j] = genum;
+        parity ^= hidden_value(c, genum);
+    }
+
+    return parity;
+}
+
+// A parity chain: the symbols y_1 = x_1 XOR x_2, y_j = y_(j-1) XOR x_(j+1)
+// (numbered after the N symbols) encode the parity of the K symbols x_j
+// of the chain in 4 clauses each, and y_(K-1) has the parity of their
+// hidden values
+void parity_chain(chunk *c, long chain)
+{
+    int parity = chain_symbols(c, chain);
+    long y = N + chain * (K - 1);
+    long a = c->_lits[0];
+
+    for(long j = 1; j < K; j++)
+    {
+        long b = c->_lits[j];
+        long xor[4][3] = {{-(y + j), a, b}, {-(y + j), -a, -b}, {y + j, -a, b}, {y + j, a, -b}};
+
+        for(int i = 0; i < 4; i++)
+            put_clause(c, xor[i], 3);
+
+        a = y + j;
+    }
+
+    a = ((parity) ? (a) : (-a));
+    put_clause(c, &a, 1);
+}
 
-            problem[i][j] = ((p < 5) ? (-genum) : (genum));
+// The body of each thread: generate the text of a chunk
+void *generate_chunk(void *arg)
+{
+    chunk *c = (chunk *) arg;
+    uint64_t mix = ((uint64_t) c->_problem << 40) ^ (uint64_t) c->_index;
+    rng r;
+
+    rng_seed(&r, c->_seed ^ splitmix64(&mix));
+    c->_len = 0;
+
+    // The first chunk starts with the first line of the problem
+    if(c->_index == 0)
+    {
+        reserve(c, 4 * 24);
+
+        if(FAMILY == RANDOM || FAMILY == PLANTED)
+        {
+            put_int(c, N); c->_buf[c->_len++] = ' ';
+            put_int(c, M); c->_buf[c->_len++] = ' ';
+            put_int(c, K); c->_buf[c->_len++] = '\n';
+        }
+
+        else
+        {
+            memcpy(c->_buf + c->_len, "p cnf ", 6); c->_len += 6;
+            put_int(c, problem_symbols()); c->_buf[c->_len++] = ' ';
+            put_int(c, problem_clauses()); c->_buf[c->_len++] = '\n';
         }
     }
+
+    for(long u = c->_first; u < c->_first + c->_num; u++)
+    {
+        switch(FAMILY)
+        {
+            case RANDOM: random_clause(c, &r); put_clause(c, c->_lits, K); break;
+            case PLANTED: planted_clause(c, &r); put_clause(c, c->_lits, K); break;
+            case PIGEONHOLE: pigeonhole_unit(c, u); break;
+            case COLORING: coloring_unit(c, u, &r); break;
+            case PARITY: parity_chain(c, u); break;
+        }
+    }
+
+    return NULL;
+}
+
+// Write the text of the chunk to fp, if it is longer than a chunk (or if all is set)
+void flush_chunk(chunk *c, FILE *fp, int all)
+{
+    if(c->_len < CHUNK_BYTES && !all)
+        return;
+
+    if(fwrite(c->_buf, 1, c->_len, fp) != (size_t) c->_len)
+    {
+        fprintf(stderr, "Cannot write the answer of the problem %d\n", c->_problem + 1);
+        exit(1);
+    }
+
+    c->_len = 0;
 }
 
-// Write the problem to a file.
-void create_file(int fnum, char *fprefix, int problem[M][K])
+// Write the value (1 or -1) of the next symbol of an answer
+void put_value(chunk *c, FILE *fp, int value)
+{
+    reserve(c, 4);
+    put_int(c, ((value) ? (1) : (-1)));
+    c->_buf[c->_len++] = ' ';
+    flush_chunk(c, fp, 0);
+}
+
+// Write the known answer of the problem of the chunk c to fp, as the solver
+// writes a solution: the value of each symbol, or nothing when the problem
+// has no solution. It is only one of the solutions of the problem.
+void write_answer(chunk *c, FILE *fp)
+{
+    c->_len = 0;
+
+    switch(FAMILY)
+    {
+        case PLANTED:
+            for(long x = 1; x <= N; x++)
+                put_value(c, fp, hidden_value(c, x));
+            break;
+
+        case COLORING:
+            for(long v = 0; v < N; v++)
+            {
+                long colour = hidden_colour(c, v);
+
+                for(long col = 0; col < K; col++)
+                    put_value(c, fp, col == colour);
+            }
+            break;
+
+        case PARITY:
+            for(long x = 1; x <= N; x++)
+                put_value(c, fp, hidden_value(c, x));
+
+            // The values of the y symbols of each chain
+            for(long chain = 0; chain < M; chain++)
+            {
+                int parity;
+
+                chain_symbols(c, chain);
+                parity = hidden_value(c, c->_lits[0]);
+
+                for(long j = 1; j < K; j++)
+                {
+                    parity ^= hidden_value(c, c->_lits[j]);
+                    put_value(c, fp, parity);
+                }
+            }
+            break;
+
+        default:
+            break;
+    }
+
+    flush_chunk(c, fp, 1);
+}
+
+// Write the chunks that were generated, in order, opening
+// the file of a problem at its first chunk
+FILE *write_chunks(chunk *chunks, int num, char *fprefix, FILE *fp)
 {
-    FILE *fp;
     char fname[100];
 
-    snprintf(fname, sizeof(fname), "%s_%d.txt", fprefix, fnum + 1);
+    for(int i = 0; i < num; i++)
+    {
+        chunk *c = &chunks[i];
 
-    fp = fopen(fname, "w");
+        if(c->_index == 0)
+        {
+            if(fp != NULL && fp != stdout)
+                fclose(fp);
 
-    fprintf(fp, "%d %d %d\n", N, M, K);
+            if(strcmp(fprefix, "-") == 0)
+                fp = stdout;
+
+            else
+            {
+                snprintf(fname, sizeof(fname), "%s_%d.txt", fprefix, c->_problem + 1);
+
+                if((fp = fopen(fname, "w")) == NULL)
+                {
+                    fprintf(stderr, "Cannot create the file %s\n", fname);
+                    exit(1);
+                }
+            }
+        }
+
+        if(fwrite(c->_buf, 1, c->_len, fp) != (size_t) c->_len)
+        {
+            fprintf(stderr, "Cannot write the problem %d\n", c->_problem + 1);
+            exit(1);
+        }
+    }
 
-    for(int i = 0; i < M; i++)
+    return fp;
+}
+
+// Make the buffers of a chunk
+void chunk_create(chunk *c, uint64_t seed)
+{
+    memset(c, 0, sizeof(chunk));
+    c->_seed = seed;
+    c->_width = literal_width();
+    c->_cap = CHUNK_BYTES + 4 * 24;
+    c->_buf = (char *) malloc(c->_cap);
+    c->_lits = (long *) malloc(((FAMILY == PIGEONHOLE) ? (N) : (K)) * sizeof(long));
+    c->_hash_size = 4;
+
+    while(c->_hash_size < 2 * K)
+        c->_hash_size *= 2;
+
+    c->_hash = (long *) malloc(c->_hash_size * sizeof(long));
+}
+
+void chunk_destroy(chunk *c)
+{
+    free(c->_buf); free(c->_lits); free(c->_hash);
+}
+
+// Create n problem files of the family, with the chunks generated by
+// threads threads. The chunks of a round are generated while the
+// chunks of the previous round are written.
+void problem_creator(int n, char *fname, uint64_t seed, int threads)
+{
+    long units = CHUNK_BYTES / (unit_literals() * literal_width()) + 1;     // The units of a chunk
+    long per_problem = (problem_units() + units - 1) / units;
+    long total = n * per_problem;
+    chunk *chunks[2];
+    pthread_t *tids = (pthread_t *) malloc(threads * sizeof(pthread_t));
+    int num[2] = {0, 0};
+    FILE *fp = NULL;
+
+    for(int s = 0; s < 2; s++)
     {
-        int j;
-        for(j = 0; j < K - 1; j++)
-            fprintf(fp, "%d ", problem[i][j]);
+        chunks[s] = (chunk *) malloc(threads * sizeof(chunk));
 
-        fprintf(fp, "%d\n", problem[i][j]);
+        for(int t = 0; t < threads; t++)
+            chunk_create(&chunks[s][t], seed);
     }
 
-    fclose(fp);
+    for(long round = 0; round * threads < total + threads; round++)
+    {
+        int s = round % 2;
+        int started = 0;
+
+        num[s] = 0;
+
+        for(long id = round * threads; id < total && num[s] < threads; id++)
+        {
+            chunk *c = &chunks[s][num[s]++];
+
+            c->_problem = id / per_problem;
+            c->_index = id % per_problem;
+            c->_first = c->_index * units;
+            c->_num = ((problem_units() - c->_first < units) ? (problem_units() - c->_first) : (units));
+        }
+
+        for(; started < num[s]; started++)
+            if(pthread_create(&tids[started], NULL, generate_chunk, &chunks[s][started]) != 0)
+                break;
+
+        // Without more threads, the rest are generated by this one
+        for(int i = started; i < num[s]; i++)
+            generate_chunk(&chunks[s][i]);
+
+        if(round > 0)
+            fp = write_chunks(chunks[1 - s], num[1 - s], fname, fp);
+
+        for(int i = 0; i < started; i++)
+            pthread_join(tids[i], NULL);
+    }
+
+    if(fp != NULL && fp != stdout)
+        fclose(fp);
+
+    fflush(stdout);
+
+    for(int s = 0; s < 2; s++)
+    {
+        for(int t = 0; t < threads; t++)
+            chunk_destroy(&chunks[s][t]);
+
+        free(chunks[s]);
+    }
+
+    free(tids);
 }
 
-// Create n random problem files
-void problem_creator(int n, char *fname)
+// Write the known answers of the n problems: each one to <fprefix>_x.ans,
+// or all of them to the file answers, one line for each problem, as the
+// solver writes the solutions of a stream of problems
+void answer_creator(int n, char *fprefix, char *answers, uint64_t seed)
 {
+    char fname[100];
+    FILE *fp = NULL;
+    chunk c;
+
+    // The answer of a random problem is not known
+    if(FAMILY == RANDOM || (answers == NULL && strcmp(fprefix, "-") == 0))
+        return;
+
+    chunk_create(&c, seed);
+
     for(int i = 0; i < n; i++)
     {
-        int problem[M][K];
+        if(answers == NULL || i == 0)
+        {
+            if(answers == NULL)
+                snprintf(fname, sizeof(fname), "%s_%d.ans", fprefix, i + 1);
+            else
+                snprintf(fname, sizeof(fname), "%s", answers);
+
+            if((fp = fopen(fname, "w")) == NULL)
+            {
+                fprintf(stderr, "Cannot create the file %s\n", fname);
+                exit(1);
+            }
+        }
+
+        else
+            fputc('\n', fp);
+
+        c._problem = i;
+        write_answer(&c, fp);
+
+        if(answers == NULL || i == n - 1)
+            fclose(fp);
+    }
+
+    chunk_destroy(&c);
+}
+
+// If the hidden colouring of every problem has two vertices of different
+// colours, so the edges can join them
+int colourable(int n, uint64_t seed)
+{
+    chunk c;
+
+    c._seed = seed;
+
+    for(c._problem = 0; c._problem < n; c._problem++)
+    {
+        long v = 1;
 
-        random_problem(problem);
-        create_file(i, fname, problem);
+        while(v < N && hidden_colour(&c, v) == hidden_colour(&c, 0))
+            v++;
+
+        if(v == N)
+            return 0;
     }
+
+    return 1;
+}
+
+// If the arguments make sense for the family
+int valid_arguments(int n, int threads)
+{
+    if(n <= 0 || threads <= 0)
+        return 0;
+
+    switch(FAMILY)
+    {
+        case RANDOM: return M > 0 && K > 0 && K <= N;
+        case PLANTED: return M > 0 && K > 1 && K <= N;
+        case PIGEONHOLE: return N > 0;
+        case COLORING: return M > 0 && K > 1 && N > 1;
+        case PARITY: return M > 0 && K > 1 && K <= N;
+    }
+
+    return 0;
 }
 
 int main(int argc, char **argv)
 {
     int n;  // Number of problems to be generated
+    uint64_t seed = rng_default_seed();
+    int threads = (int) sysconf(_SC_NPROCESSORS_ONLN);
+    char *answers = NULL;   // The file of all the answers, if given
 
-    srand((unsigned) time(NULL));
-
-    if(argc != 6)
+    if(argc < 6)
     {
         syntax_message();
         exit(0);
     }
 
+    for(int i = 6; i < argc; i++)
+    {
+        if(strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+            seed = strtoull(argv[++i], NULL, 10);
+
+        else if(strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+            threads = strtol(argv[++i], NULL, 10);
+
+        else if(strcmp(argv[i], "--answers") == 0 && i + 1 < argc)
+            answers = argv[++i];
+
+        else if(strcmp(argv[i], "--family") == 0 && i + 1 < argc)
+        {
+            int f = 0;
+
+            i++;
+
+            while(f <= PARITY && strcmp(argv[i], family_name[f]) != 0)
+                f++;
+
+            if(f > PARITY)
+            {
+                syntax_message();
+                exit(0);
+            }
+
+            FAMILY = (enum family) f;
+        }
+
+        else
+        {
+            syntax_message();
+            exit(0);
+        }
+    }
+
     M = strtol(argv[1], NULL, 10);
     N = strtol(argv[2], NULL, 10);
     K = strtol(argv[3], NULL, 10);
     n = strtol(argv[4], NULL, 10);
 
+    if(!valid_arguments(n, threads))
+        syntax_message();
 
+    else if(FAMILY == COLORING && !colourable(n, seed))
+        fprintf(stderr, "The hidden colouring has a single colour, use more vertices or another seed\n");
 
-    if(n <= 0 || K > N)
-        syntax_message();
     else
-        problem_creator(n, argv[5]);
+    {
+        problem_creator(n, argv[5], seed, threads);
+        answer_creator(n, argv[5], answers, seed);
+
+        // The standard output may hold the problems
+        fprintf(((strcmp(argv[5], "-") == 0) ? (stderr) : (stdout)), "Seed: %llu\n", (unsigned long long) seed);
+    }
 
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,170 @@
+/*
+	A test of the local search loop (walk_solve, see walksat.h): the
+	search must not allocate any memory while it runs, as all its
+	buffers are allocated by walk_create. Each method is run for N and
+	for 10 * N steps on the same problem, and the number of calls of
+	malloc, calloc and realloc made by the search must be the same.
+
+	The calls are counted by replacing malloc, calloc and realloc with
+	macros, before the headers of the solvers are included, so only the
+	calls of the solvers are counted. The system headers they use are
+	included first, so the macros do not change them.
+
+	Syntax:
+	alloc-test
+
+	It prints a line for each method and exits with 1 if the count of
+	any of them grows with the steps.
+
+	Kefsenidis Paraskevas, 2023
+*/
+
+#include <math.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#define STEPS	20000		// The steps of the short run (the long one makes 10 times more)
+#define TRIES	2
+
+long allocations = 0;		// The calls of malloc, calloc and realloc of the solvers
+
+void *count_malloc(size_t size)
+{
+	allocations++;
+	return malloc(size);
+}
+
+void *count_calloc(size_t num, size_t size)
+{
+	allocations++;
+	return calloc(num, size);
+}
+
+void *count_realloc(void *ptr, size_t size)
+{
+	allocations++;
+	return realloc(ptr, size);
+}
+
+#define malloc(size) count_malloc(size)
+#define calloc(num, size) count_calloc(num, size)
+#define realloc(ptr, size) count_realloc(ptr, size)
+
+#include "../Algorithms/walksat.h"
+#include "../Algorithms/probsat.h"
+#include "../Algorithms/cwls.h"
+
+// Make a random problem with n symbols and m clauses of 3 literals. At
+// m = 5 * n there is almost never a solution, so every run uses all of
+// its steps.
+void random_problem(cnf *f, int n, int m, uint64_t seed)
+{
+	rng r;
+
+	rng_seed(&r, seed);
+	memset(f, 0, sizeof(cnf));
+	f->_n = n;
+	f->_m = m;
+	f->_k = 3;
+	f->_start = (int *) malloc((m + 1) * sizeof(int));
+	f->_lits = (int *) malloc(3 * m * sizeof(int));
+	f->_card_start = (int *) calloc(1, sizeof(int));
+	f->_card_lits = (int *) malloc(sizeof(int));
+	f->_card_bound = (int *) malloc(sizeof(int));
+
+	for(int i = 0; i < m; i++)
+	{
+		f->_start[i] = 3 * i;
+
+		for(int j = 0; j < 3; j++)
+			f->_lits[3 * i + j] = rng_bounded(&r, 2 * n);
+	}
+
+	f->_start[m] = 3 * m;
+}
+
+// The allocations of a search of the method on f, with steps flips in
+// each try. The result of the search is stored in result.
+long search_allocations(cnf *f, local_method method, int adaptive, long screen, long steps, enum walk_result *result)
+{
+	walk_solver w;
+	prob_data p;
+	cw_data c;
+	long before;
+
+	walk_defaults(&w);
+	w._seed = 1;
+	w._max_flips = steps;
+	w._max_tries = TRIES;
+	w._adaptive = adaptive;
+	w._screen = screen;
+	walk_create(&w, f);
+	walk_noise_init(&w);
+
+	if(method._pick == prob_pick_lit)
+		probsat_create(&w, &p, 3);
+	else if(method._pick == cw_pick_lit)
+		cw_create(&w, &c);
+
+	before = allocations;
+	*result = walk_solve(&w, method);
+	before = allocations - before;
+
+	if(method._pick == prob_pick_lit)
+		probsat_destroy(&w, &p);
+	else if(method._pick == cw_pick_lit)
+		cw_destroy(&w, &c);
+
+	walk_destroy(&w);
+
+	return before;
+}
+
+int main(void)
+{
+	struct
+	{
+		char *_name;
+		local_method _method;
+		int _adaptive;
+		long _screen;
+	} tests[] = {
+		{"WalkSAT", {"WalkSAT", pick_lit, NULL, NULL}, 0, 0},
+		{"WalkSAT --adaptive", {"WalkSAT", pick_lit, NULL, NULL}, 1, 0},
+		{"WalkSAT --screen 512", {"WalkSAT", pick_lit, NULL, NULL}, 0, 512},
+		{"ProbSAT", {"ProbSAT", prob_pick_lit, NULL, NULL}, 0, 0},
+		{"CWLS", {"CWLS", cw_pick_lit, cw_start, cw_flipped}, 0, 0}
+	};
+	int tests_num = sizeof(tests) / sizeof(tests[0]);
+	int failed = 0;
+	cnf f;
+
+	random_problem(&f, 400, 2000, 7);
+
+	for(int i = 0; i < tests_num; i++)
+	{
+		enum walk_result short_result, long_result;
+		long short_allocs = search_allocations(&f, tests[i]._method, tests[i]._adaptive, tests[i]._screen, STEPS, &short_result);
+		long long_allocs = search_allocations(&f, tests[i]._method, tests[i]._adaptive, tests[i]._screen, 10 * STEPS, &long_result);
+
+		// A search that stops early makes fewer steps, and proves nothing
+		int ok = (short_allocs == long_allocs && short_result == WALK_STEP_LIMIT && long_result == WALK_STEP_LIMIT);
+
+		printf("%-22s %ld allocations in %d steps, %ld in %d steps: %s\n", tests[i]._name, short_allocs,
+			   TRIES * STEPS, long_allocs, 10 * TRIES * STEPS, ((ok) ? ("ok") : ("FAILED")));
+
+		failed |= !ok;
+	}
+
+	free_cnf(&f);
+
+	return failed;
+}
@@ -0,0 +1,204 @@
+/*
+	A test of the incremental interface (see incremental.h). Clauses are
+	added in rounds to random problems, and after each round the clauses
+	are solved under random assumptions, then the answer is checked by
+	trying all the truth assignments:
+	- a model must satisfy the clauses and the assumptions,
+	- an unsatisfiable solve must have no model, its failed assumptions
+	  must be some of the assumptions, and the clauses must have no model
+	  with only the failed assumptions true.
+	It also checks a small problem where only one of the assumptions is
+	used by the refutation, so only that one must be failed.
+
+	Syntax:
+	incremental-test
+
+	It prints the number of solves of each answer and exits with 1 if any
+	check fails.
+
+	Kefsenidis Paraskevas, 2023
+*/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "../Algorithms/dpll.h"
+#include "../Algorithms/incremental.h"
+
+#define VARS		12			// The symbols of each random problem
+#define ROUNDS		12			// The rounds of clauses of each problem
+#define ROUND_SIZE	5			// The clauses added in each round
+#define SOLVES		4			// The solves after each round
+#define PROBLEMS	200
+
+// The clauses added to the solver, kept for the checks (3 literals each)
+int clauses[ROUNDS * ROUND_SIZE * 3];
+int clauses_num = 0;
+
+// If the truth assignment of the bits of x (bit i for the symbol i + 1)
+// satisfies the clauses and the num literals of assumptions
+int satisfies(unsigned x, int *assumptions, int num)
+{
+	for(int i = 0; i < num; i++)
+		if((int) ((x >> (abs(assumptions[i]) - 1)) & 1) != (assumptions[i] > 0))
+			return 0;
+
+	for(int i = 0; i < clauses_num; i++)
+	{
+		int sat = 0;
+
+		for(int j = 0; j < 3 && !sat; j++)
+			sat = ((int) ((x >> (abs(clauses[i * 3 + j]) - 1)) & 1) == (clauses[i * 3 + j] > 0));
+
+		if(!sat)
+			return 0;
+	}
+
+	return 1;
+}
+
+// If the clauses have a model with the assumptions true
+int brute_force(int *assumptions, int num)
+{
+	for(unsigned x = 0; x < (1u << VARS); x++)
+		if(satisfies(x, assumptions, num))
+			return 1;
+
+	return 0;
+}
+
+// Check the answer of a solve under the num assumptions. Returns 0 if it
+// is wrong.
+int check_solve(inc_solver *s, enum dpll_result result, int *assumptions, int num)
+{
+	int failed[VARS];
+	int failed_num = 0;
+	unsigned x = 0;
+
+	if(result == DPLL_SAT)
+	{
+		for(int v = 1; v <= VARS; v++)
+			if(inc_value(s, v) == 1)
+				x |= 1u << (v - 1);
+
+		return satisfies(x, assumptions, num);
+	}
+
+	if(result != DPLL_UNSAT || brute_force(assumptions, num))
+		return 0;
+
+	// (an assumption may be repeated, but is failed once)
+	for(int i = 0; i < num; i++)
+	{
+		int repeated = 0;
+
+		for(int j = 0; j < i; j++)
+			repeated |= (assumptions[j] == assumptions[i]);
+
+		if(!repeated && inc_failed(s, assumptions[i]))
+			failed[failed_num++] = assumptions[i];
+	}
+
+	return (failed_num == s->_failed_num && !brute_force(failed, failed_num));
+}
+
+// The clauses (1 2), (1 -2) and (-1 3) with the assumptions -3, 4 and 5:
+// only -3 is needed to refute them
+int check_core(void)
+{
+	int problem[3][2] = {{1, 2}, {1, -2}, {-1, 3}};
+	int assumptions[3] = {4, -3, 5};
+	int clause[2] = {-4, -1};
+	int ok, result;
+	inc_solver s;
+
+	inc_create(&s);
+
+	for(int i = 0; i < 3; i++)
+		inc_add_clause(&s, problem[i], 2);
+
+	result = inc_solve(&s, assumptions, 3);
+	ok = (result == DPLL_UNSAT && s._failed_num == 1 && inc_failed(&s, -3));
+
+	// Without -3 the clauses are satisfiable, and with a new clause that
+	// needs -4 the assumption 4 fails alone
+	inc_add_clause(&s, clause, 2);
+	result = inc_solve(&s, assumptions, 1);
+	ok &= (result == DPLL_UNSAT && s._failed_num == 1 && inc_failed(&s, 4));
+
+	assumptions[0] = 5;
+	result = inc_solve(&s, assumptions, 1);
+	ok &= (result == DPLL_SAT && inc_value(&s, 1) == 1 && inc_value(&s, 4) == -1 && inc_value(&s, 5) == 1);
+
+	inc_destroy(&s);
+
+	return ok;
+}
+
+int main(void)
+{
+	long sat = 0, unsat = 0, reused = 0, learned = 0;
+	int failed = 0;
+
+	srand(11);
+
+	for(int p = 0; p < PROBLEMS; p++)
+	{
+		inc_solver s;
+
+		inc_create(&s);
+		clauses_num = 0;
+
+		for(int r = 0; r < ROUNDS && !failed; r++)
+		{
+			for(int i = 0; i < ROUND_SIZE; i++)
+			{
+				int *clause = clauses + clauses_num * 3;
+
+				for(int j = 0; j < 3; j++)
+					clause[j] = (rand() % VARS + 1) * ((rand() % 2) ? (1) : (-1));
+
+				inc_add_clause(&s, clause, 3);
+				clauses_num++;
+			}
+
+			for(int t = 0; t < SOLVES && !failed; t++)
+			{
+				int assumptions[5];
+				int num = rand() % 6;
+				enum dpll_result result;
+
+				for(int i = 0; i < num; i++)
+					assumptions[i] = (rand() % VARS + 1) * ((rand() % 2) ? (1) : (-1));
+
+				result = inc_solve(&s, assumptions, num);
+
+				if(!check_solve(&s, result, assumptions, num))
+				{
+					printf("problem %d, round %d, solve %d: wrong answer\n", p, r, t);
+					failed = 1;
+				}
+
+				sat += (result == DPLL_SAT);
+				unsat += (result == DPLL_UNSAT);
+				reused += s._reused;
+			}
+		}
+
+		learned += s._learned;
+		inc_destroy(&s);
+	}
+
+	if(!check_core())
+	{
+		printf("the failed assumptions of the small problem are wrong\n");
+		failed = 1;
+	}
+
+	printf("%ld satisfiable solves (%ld with the last model), %ld unsatisfiable, %ld learned clauses: %s\n",
+		   sat, reused, unsat, learned, ((failed) ? ("FAILED") : ("ok")));
+
+	return failed;
+}
@@ -0,0 +1,118 @@
+/*
+	A test of the time limit of the hybrid method (see hybrid.h): the
+	limit is the one of the whole solve, so WalkSAT and DPLL together must
+	stop within it. A random problem with no solution (3 literals in each
+	clause, 6 clauses for each symbol) is solved with a time limit of
+	LIMIT seconds twice:
+	- with WalkSAT steps for much longer than the limit, so WalkSAT uses
+	  all of the time and DPLL never starts,
+	- with few WalkSAT steps, so DPLL gets the rest of the time, and stops
+	  at the end of it.
+	Each solve must end within the limit plus MARGIN seconds.
+
+	Syntax:
+	timeout-test
+
+	It prints the wall clock time of each solve and exits with 1 if any of
+	them is too long.
+
+	Kefsenidis Paraskevas, 2023
+*/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "../Algorithms/walksat.h"
+#include "../Algorithms/dpll.h"
+#include "../Algorithms/hybrid.h"
+
+#define LIMIT	1.0			// The time limit of each solve (in seconds)
+#define MARGIN	0.25		// The time a solve may take after its limit
+#define VARS	250
+#define CLAUSES	1500
+
+// Write a random problem to a new temporary file, with its name in name
+int write_problem(char *name)
+{
+	int fd = mkstemp(name);
+	FILE *f;
+
+	if(fd < 0 || (f = fdopen(fd, "w")) == NULL)
+		return -1;
+
+	srand(5);
+	fprintf(f, "%d %d 3\n", VARS, CLAUSES);
+
+	for(int i = 0; i < CLAUSES; i++)
+		for(int j = 0; j < 3; j++)
+			fprintf(f, "%d%c", (rand() % VARS + 1) * ((rand() % 2) ? (1) : (-1)), ((j < 2) ? (' ') : ('\n')));
+
+	fclose(f);
+
+	return 0;
+}
+
+// The wall clock time of a hybrid solve of the problem in the file name,
+// with WalkSAT tries of flips steps
+double hybrid_time(char *name, long flips)
+{
+	walk_solver w;
+	dpll_solver d;
+	problem pb;
+	double t;
+
+	memset(&pb, 0, sizeof(problem));
+	pb._preprocessing = 1;
+	walk_defaults(&w);
+	dpll_defaults(&d);
+	w._seed = 1;
+	w._max_flips = flips;
+	w._time_limit = LIMIT;
+	d._time_limit = LIMIT;		// (as --timeout sets it)
+
+	if(load_problem(name, &pb))
+		return -1;
+
+	dpll_create(&d, &pb._cnf);
+	walk_create(&w, &pb._cnf);
+
+	t = wall_time();
+	hybrid(&w, &d, &pb, "/dev/null");
+	t = wall_time() - t;
+
+	dpll_destroy(&d);
+	walk_destroy(&w);
+	free_problem(&pb);
+
+	return t;
+}
+
+int main(void)
+{
+	char name[] = "/tmp/timeout-test-XXXXXX";
+	long flips[] = {1000000000, 1000};
+	char *names[] = {"WalkSAT out of time", "WalkSAT out of steps"};
+	int failed = 0;
+
+	if(write_problem(name))
+	{
+		printf("The problem could not be written\n");
+		return 1;
+	}
+
+	for(int i = 0; i < 2; i++)
+	{
+		double t = hybrid_time(name, flips[i]);
+		int ok = (t >= 0 && t <= LIMIT + MARGIN);
+
+		printf("\n%s: %f secs with a limit of %.2f: %s\n", names[i], t, LIMIT, ((ok) ? ("ok") : ("FAILED")));
+		failed |= !ok;
+	}
+
+	unlink(name);
+
+	return failed;
+}